@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Замер режимов маршрутизатора на одном входе.
+
+    python3 bench/bench_routers.py path/to/transport_catalogue INPUT.json [--modes m1,m2,...] [--repeat R]
+
+Для каждого режима программа запускается дважды: без stat_requests (чтение базы и
+построение маршрутизатора) и с ними. Время построения - первый запуск, время запросов -
+разность. Из R повторов берется лучшее время. Пиковая память - по полному запуску.
+Ответы Route сравниваются с ответами первого режима по total_time и по наличию маршрута.
+
+Режим all_pairs хранит матрицу на все пары вершин и на больших сетях не помещается
+в память, поэтому для них режимы перечисляются явно, например
+--modes on_demand,contraction_hierarchies,raptor.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+ROUTER_MODES = ["all_pairs", "on_demand", "contraction_hierarchies", "raptor"]
+REL_TOLERANCE = 1e-5
+
+
+def run(binary, input_file):
+    """Время работы в секундах, пиковая память в КБ и вывод программы."""
+    with open(input_file) as input_stream, tempfile.TemporaryFile() as output_stream:
+        start = time.perf_counter()
+        process = subprocess.Popen([binary], stdin=input_stream, stdout=output_stream)
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.perf_counter() - start
+        if status != 0:
+            raise RuntimeError("%s failed with status %d" % (binary, status))
+        output_stream.seek(0)
+        return elapsed, usage.ru_maxrss, output_stream.read().decode()
+
+
+def write_input(document, mode, stat_requests, directory):
+    document = dict(document, stat_requests=stat_requests)
+    document["routing_settings"] = dict(document["routing_settings"], router_mode=mode)
+    file = os.path.join(directory, "%s_%d.json" % (mode, len(stat_requests)))
+    with open(file, "w") as stream:
+        json.dump(document, stream)
+    return file
+
+
+def route_totals(output, requests):
+    route_ids = {request["id"] for request in requests if request["type"] == "Route"}
+    return {response["request_id"]: response.get("total_time")
+            for response in json.loads(output) if response["request_id"] in route_ids}
+
+
+def count_differences(totals, reference):
+    differences = 0
+    for request_id, total in reference.items():
+        actual = totals.get(request_id)
+        if (actual is None) != (total is None):
+            differences += 1
+        elif total is not None and abs(actual - total) > REL_TOLERANCE * max(1.0, abs(total)):
+            differences += 1
+    return differences
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Замер режимов маршрутизатора")
+    parser.add_argument("binary")
+    parser.add_argument("input")
+    parser.add_argument("--modes", default=",".join(ROUTER_MODES))
+    parser.add_argument("--repeat", type=int, default=1)
+    args = parser.parse_args()
+    binary = os.path.abspath(args.binary)
+
+    with open(args.input) as stream:
+        document = json.load(stream)
+    requests = document["stat_requests"]
+    routes_count = sum(request["type"] == "Route" for request in requests)
+    print("%s: %d requests, %d of them Route" % (args.input, len(requests), routes_count))
+    print("%-24s %10s %10s %10s %10s  %s" % ("mode", "build, s", "queries, s", "total, s", "peak, MB",
+                                              "Route totals"))
+
+    reference = None
+    with tempfile.TemporaryDirectory() as directory:
+        for mode in args.modes.split(","):
+            build_input = write_input(document, mode, [], directory)
+            full_input = write_input(document, mode, requests, directory)
+            try:
+                build_time = min(run(binary, build_input)[0] for _ in range(args.repeat))
+                total_time = None
+                for _ in range(args.repeat):
+                    elapsed, peak, output = run(binary, full_input)
+                    total_time = elapsed if total_time is None else min(total_time, elapsed)
+            except RuntimeError as error:
+                print("%-24s %s" % (mode, error))
+                continue
+            totals = route_totals(output, requests)
+            if reference is None:
+                reference = totals
+                comparison = "reference"
+            else:
+                comparison = "%d differ" % count_differences(totals, reference)
+            print("%-24s %10.3f %10.3f %10.3f %10.1f  %s" % (
+                mode, build_time, max(0.0, total_time - build_time), total_time, peak / 1024, comparison))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
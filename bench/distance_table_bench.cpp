@@ -0,0 +1,178 @@
+// Замер поиска дорожных расстояний: t_c::DistanceTable против прежней
+// std::unordered_map по парам указателей на остановки с DistanceHasher.
+//
+//     g++ -std=c++17 -O2 -I transport-catalogue -o distance_table_bench
+//         bench/distance_table_bench.cpp transport-catalogue/distance_table.cpp
+//     ./distance_table_bench [STOPS] [BUSES] [LENGTH] [REPEAT]
+//
+// Сеть строится так же, как в gen_network.py: остановки в узлах квадратной сетки,
+// автобусы - случайные блуждания по соседним узлам длиной до LENGTH остановок,
+// расстояния заданы между соседними остановками маршрутов в обе стороны.
+// Запросы - все отрезки маршрутов в прямом и обратном направлении (как при подсчете
+// длин маршрутов в справочнике), весь набор повторяется REPEAT раз.
+// По умолчанию: 10000 остановок, 1000 автобусов, 25 остановок, 50 повторов
+
+#include "distance_table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Stop {
+    uint32_t id;
+};
+
+// хешер из прежнего TransportCatalogue: сумма хешей указателей, поэтому (A, B) и (B, A)
+// всегда попадают в одну корзину
+class DistanceHasher {
+public:
+    size_t operator()(const std::pair<Stop*, Stop*>& element) const {
+        size_t hash = std::hash<const void*>{}(element.first);
+        hash += std::hash<const void*>{}(element.second);
+        return hash;
+    }
+};
+
+using DistanceMap = std::unordered_map<std::pair<Stop*, Stop*>, double, DistanceHasher>;
+
+struct Network {
+    std::vector<std::tuple<uint32_t, uint32_t, double>> distances;
+    std::vector<std::pair<uint32_t, uint32_t>> lookups;
+};
+
+Network MakeNetwork(uint32_t stops_count, uint32_t buses_count, uint32_t route_length) {
+    std::mt19937 random(1);
+    const uint32_t side = static_cast<uint32_t>(std::sqrt(stops_count)) + 1;
+    const auto neighbours = [side, stops_count](uint32_t stop) {
+        std::vector<uint32_t> result;
+        const int64_t x = stop % side;
+        const int64_t y = stop / side;
+        for (const auto& [dx, dy] : {std::pair{1, 0}, {-1, 0}, {0, 1}, {0, -1}}) {
+            const int64_t nx = x + dx;
+            const int64_t ny = y + dy;
+            const int64_t other = ny * side + nx;
+            if (nx >= 0 && nx < side && ny >= 0 && ny < side && other < stops_count) {
+                result.push_back(static_cast<uint32_t>(other));
+            }
+        }
+        return result;
+    };
+
+    Network network;
+    std::uniform_int_distribution<uint32_t> any_stop(0, stops_count - 1);
+    std::uniform_int_distribution<int> any_distance(80, 200);
+    for (uint32_t bus = 0; bus < buses_count; ++bus) {
+        uint32_t current = any_stop(random);
+        std::vector<uint32_t> route{current};
+        std::unordered_set<uint32_t> visited{current};
+        while (route.size() < route_length) {
+            std::vector<uint32_t> candidates = neighbours(current);
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                [&visited](uint32_t stop) { return visited.count(stop) > 0; }), candidates.end());
+            if (candidates.empty()) {
+                break;
+            }
+            current = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(random)];
+            route.push_back(current);
+            visited.insert(current);
+        }
+        for (size_t i = 1; i < route.size(); ++i) {
+            network.distances.emplace_back(route[i - 1], route[i], any_distance(random));
+            network.distances.emplace_back(route[i], route[i - 1], any_distance(random));
+            network.lookups.emplace_back(route[i - 1], route[i]);
+            network.lookups.emplace_back(route[i], route[i - 1]);
+        }
+    }
+    return network;
+}
+
+double FindDistance(const DistanceMap& distances, Stop* first, Stop* second) {
+    if (const auto it = distances.find({first, second}); it != distances.end()) {
+        return it->second;
+    }
+    if (const auto it = distances.find({second, first}); it != distances.end()) {
+        return it->second;
+    }
+    return -1;
+}
+
+double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void PrintResult(const char* name, double build_ms, double lookup_ms, double lookups, double checksum) {
+    std::cout << name << ": build " << build_ms << " ms, lookup " << lookup_ms * 1e6 / lookups
+              << " ns (" << lookups / lookup_ms / 1e3 << " M/s), checksum " << checksum << '\n';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto argument = [argc, argv](int index, uint32_t value) {
+        return index < argc ? static_cast<uint32_t>(std::atoi(argv[index])) : value;
+    };
+    const uint32_t stops_count = argument(1, 10000);
+    const uint32_t buses_count = argument(2, 1000);
+    const uint32_t route_length = argument(3, 25);
+    const uint32_t repeat = argument(4, 50);
+
+    const Network network = MakeNetwork(stops_count, buses_count, route_length);
+    const double lookups = static_cast<double>(network.lookups.size()) * repeat;
+    std::cout << stops_count << " stops, " << buses_count << " buses, " << network.distances.size()
+              << " distances, " << network.lookups.size() << " lookups x " << repeat << '\n';
+
+    using Clock = std::chrono::steady_clock;
+
+    // остановки, как и прежде, лежат в deque, и ключи - их адреса
+    std::deque<Stop> stops;
+    for (uint32_t id = 0; id < stops_count; ++id) {
+        stops.push_back({id});
+    }
+    const Clock::time_point map_start = Clock::now();
+    DistanceMap map;
+    for (const auto& [from, to, distance] : network.distances) {
+        map[{&stops[from], &stops[to]}] = distance;
+    }
+    const Clock::time_point map_built = Clock::now();
+    double map_checksum = 0;
+    for (uint32_t i = 0; i < repeat; ++i) {
+        for (const auto& [from, to] : network.lookups) {
+            map_checksum += FindDistance(map, &stops[from], &stops[to]);
+        }
+    }
+    const Clock::time_point map_done = Clock::now();
+    PrintResult("std::unordered_map", ToMilliseconds(map_built - map_start),
+                ToMilliseconds(map_done - map_built), lookups, map_checksum);
+
+    const Clock::time_point table_start = Clock::now();
+    t_c::DistanceTable table;
+    table.Reserve(network.distances.size());
+    for (const auto& [from, to, distance] : network.distances) {
+        table.Add(from, to, distance);
+    }
+    const Clock::time_point table_built = Clock::now();
+    double table_checksum = 0;
+    for (uint32_t i = 0; i < repeat; ++i) {
+        for (const auto& [from, to] : network.lookups) {
+            table_checksum += table.Find(from, to);
+        }
+    }
+    const Clock::time_point table_done = Clock::now();
+    PrintResult("t_c::DistanceTable", ToMilliseconds(table_built - table_start),
+                ToMilliseconds(table_done - table_built), lookups, table_checksum);
+
+    return map_checksum == table_checksum ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Синтетическая сеть для замеров: остановки в узлах квадратной сетки с шагом 0.001
+градуса и автобусы, которые идут случайным блужданием по соседним узлам.
+
+    python3 bench/gen_network.py STOPS [--buses N] [--length L] [--routes Q] [--seed S] > input.json
+
+По умолчанию автобусов STOPS / 20, в маршруте до 25 остановок. Каждый третий автобус
+кольцевой. Дорожные расстояния между соседними остановками маршрутов - от 80 до 200 м
+в каждую сторону. Запросы: Q запросов Route между случайными остановками маршрутов,
+затем по 200 запросов Bus и Stop. Режим маршрутизатора задается при запуске замера
+(см. bench_routers.py).
+"""
+
+import argparse
+import json
+import random
+import sys
+
+RENDER_SETTINGS = {
+    "width": 1200, "height": 1200, "padding": 50,
+    "stop_radius": 3, "line_width": 2,
+    "stop_label_font_size": 10, "stop_label_offset": [7, -3],
+    "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+    "color_palette": ["green", [255, 160, 0], "red"],
+    "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+}
+
+
+def generate(stops_count, buses_count, route_length, routes_count, seed):
+    rng = random.Random(seed)
+    side = int(stops_count ** 0.5) + 1
+    stops = [{"type": "Stop", "name": "S%d" % i,
+              "latitude": 55 + i // side * 0.001, "longitude": 37 + i % side * 0.001,
+              "road_distances": {}} for i in range(stops_count)]
+
+    def neighbours(stop):
+        x, y = stop % side, stop // side
+        result = []
+        for dx, dy in ((1, 0), (-1, 0), (0, 1), (0, -1)):
+            nx, ny = x + dx, y + dy
+            other = ny * side + nx
+            if 0 <= nx < side and 0 <= ny < side and other < stops_count:
+                result.append(other)
+        return result
+
+    buses = []
+    for bus in range(buses_count):
+        current = rng.randrange(stops_count)
+        route = [current]
+        visited = {current}
+        for _ in range(route_length - 1):
+            candidates = [stop for stop in neighbours(current) if stop not in visited]
+            if not candidates:
+                break
+            current = rng.choice(candidates)
+            route.append(current)
+            visited.add(current)
+        for first, second in zip(route, route[1:]):
+            stops[first]["road_distances"]["S%d" % second] = rng.randint(80, 200)
+            stops[second]["road_distances"]["S%d" % first] = rng.randint(80, 200)
+        is_roundtrip = bus % 3 == 0
+        names = ["S%d" % stop for stop in route]
+        if is_roundtrip:
+            names.append(names[0])
+            stops[route[-1]]["road_distances"]["S%d" % route[0]] = 500
+        buses.append({"type": "Bus", "name": "B%d" % bus, "stops": names, "is_roundtrip": is_roundtrip})
+
+    used = [i for i in range(stops_count) if stops[i]["road_distances"]]
+    requests = [{"type": "Route", "from": "S%d" % rng.choice(used), "to": "S%d" % rng.choice(used)}
+                for _ in range(routes_count)]
+    requests += [{"type": "Bus", "name": "B%d" % rng.randrange(buses_count)} for _ in range(200)]
+    requests += [{"type": "Stop", "name": "S%d" % rng.randrange(stops_count)} for _ in range(200)]
+    for request_id, request in enumerate(requests):
+        request["id"] = request_id
+    return {
+        "base_requests": stops + buses,
+        "routing_settings": {"bus_wait_time": 3, "bus_velocity": 30},
+        "render_settings": RENDER_SETTINGS,
+        "stat_requests": requests,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Синтетическая сеть для замеров")
+    parser.add_argument("stops", type=int)
+    parser.add_argument("--buses", type=int)
+    parser.add_argument("--length", type=int, default=25)
+    parser.add_argument("--routes", type=int, default=1000)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+    buses = args.buses if args.buses is not None else args.stops // 20
+    json.dump(generate(args.stops, buses, args.length, args.routes, args.seed), sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Регрессионная проверка: прогоняет каждый пример из examples/ в каждом режиме
+маршрутизатора и сравнивает ответы с out.json (out.txt).
+
+    python3 examples/check_examples.py path/to/transport_catalogue [--snapshot]
+
+С --snapshot каждый пример дополнительно проходит через make_base и process_requests.
+
+Ответы Bus и Stop должны совпадать с ожидаемыми (числа - с точностью вывода), карта Map -
+с точностью до порядка атрибутов в тегах svg.
+У Route совпадают error_message и total_time. Элементы маршрута сравниваются с ожидаемыми,
+но при равных по времени вариантах разные маршрутизаторы выбирают разные пути, и
+ожидаемый путь - лишь один из них. Поэтому несовпадающие элементы принимаются, если они
+образуют корректный маршрут с тем же total_time: ожидания по bus_wait_time на остановках,
+поездки на span_count остановок по маршруту автобуса со временем по дорожным
+расстояниям, от "from" до "to". Число таких равноценных замен выводится отдельно.
+"""
+
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROUTER_MODES = ["all_pairs", "on_demand", "contraction_hierarchies", "raptor"]
+EXAMPLES_DIR = os.path.dirname(os.path.abspath(__file__))
+# числа выводятся с 6 значащими цифрами
+REL_TOLERANCE = 1e-5
+
+
+def find_examples():
+    examples = []
+    for name in sorted(os.listdir(EXAMPLES_DIR)):
+        directory = os.path.join(EXAMPLES_DIR, name)
+        for input_name, output_name in (("inp.json", "out.json"), ("inp.txt", "out.txt")):
+            input_file = os.path.join(directory, input_name)
+            if os.path.isfile(input_file):
+                examples.append((name, input_file, os.path.join(directory, output_name)))
+    return examples
+
+
+SVG_TAG = re.compile(r'<(/?[\w:]+)((?:\s+[\w:-]+="[^"]*")*)\s*(/?)>')
+SVG_ATTRIBUTE = re.compile(r'([\w:-]+)="([^"]*)"')
+
+
+def normalize_svg(text):
+    """Теги svg с атрибутами без учета их порядка и текст между тегами."""
+    parts = []
+    position = 0
+    for tag in SVG_TAG.finditer(text):
+        parts.append(text[position:tag.start()].strip())
+        parts.append((tag.group(1), sorted(SVG_ATTRIBUTE.findall(tag.group(2))), tag.group(3)))
+        position = tag.end()
+    parts.append(text[position:].strip())
+    return parts
+
+
+def is_close(lhs, rhs):
+    return abs(lhs - rhs) <= REL_TOLERANCE * max(1.0, abs(lhs), abs(rhs))
+
+
+class Network:
+    """Маршруты автобусов и расстояния из base_requests для проверки элементов маршрута."""
+
+    def __init__(self, document):
+        settings = document["routing_settings"]
+        self.wait_time = settings["bus_wait_time"]
+        self.velocity = settings["bus_velocity"]
+        self.distances = {}
+        self.routes = {}
+        for request in document["base_requests"]:
+            if request["type"] == "Stop":
+                for to, distance in request.get("road_distances", {}).items():
+                    self.distances[(request["name"], to)] = distance
+        for request in document["base_requests"]:
+            if request["type"] == "Bus":
+                stops = list(request["stops"])
+                if not request["is_roundtrip"]:
+                    stops += stops[-2::-1]
+                self.routes[request["name"]] = (stops, request.get("velocity", self.velocity))
+
+    def distance(self, from_stop, to_stop):
+        if (from_stop, to_stop) in self.distances:
+            return self.distances[(from_stop, to_stop)]
+        return self.distances.get((to_stop, from_stop))
+
+    def ride_ends(self, bus, stop, span_count, time):
+        """Остановки, куда можно доехать на bus от stop через span_count остановок за time."""
+        stops, velocity = self.routes.get(bus, ([], self.velocity))
+        ends = set()
+        for begin in range(len(stops) - span_count):
+            if stops[begin] != stop:
+                continue
+            distance = 0
+            for i in range(begin, begin + span_count):
+                segment = self.distance(stops[i], stops[i + 1])
+                if segment is None:
+                    break
+                distance += segment
+            else:
+                if is_close(distance / (velocity * 1000 / 60), time):
+                    ends.add(stops[begin + span_count])
+        return ends
+
+    def is_valid_route(self, from_stop, to_stop, items, total_time):
+        if not is_close(sum(item["time"] for item in items), total_time):
+            return False
+        current = {from_stop}
+        waiting_at = None
+        for item in items:
+            if item["type"] == "Wait":
+                if item["stop_name"] not in current or not is_close(item["time"], self.wait_time):
+                    return False
+                waiting_at = item["stop_name"]
+                current = set()
+            elif item["type"] == "Bus":
+                if waiting_at is None or item["span_count"] < 1:
+                    return False
+                current = self.ride_ends(item["bus"], waiting_at, item["span_count"], item["time"])
+                waiting_at = None
+            else:
+                return False
+        return waiting_at is None and to_stop in current
+
+
+def same_items(lhs, rhs):
+    if len(lhs) != len(rhs):
+        return False
+    for left, right in zip(lhs, rhs):
+        if set(left) != set(right):
+            return False
+        for key, value in left.items():
+            if key == "time":
+                if not is_close(value, right[key]):
+                    return False
+            elif value != right[key]:
+                return False
+    return True
+
+
+def compare_response(request, actual, expected, network):
+    """Возвращает None, "tie" для равноценной замены маршрута или текст ошибки."""
+    if set(actual) != set(expected):
+        return "keys %s != %s" % (sorted(actual), sorted(expected))
+    for key, value in expected.items():
+        if key == "items":
+            continue
+        if key == "map":
+            if normalize_svg(actual[key]) != normalize_svg(value):
+                return "map differs"
+        elif isinstance(value, float) or key in ("curvature", "route_length", "total_time"):
+            if not is_close(actual[key], value):
+                return "%s: %s != %s" % (key, actual[key], value)
+        elif actual[key] != value:
+            return "%s differs" % key
+    if "items" not in expected or same_items(actual["items"], expected["items"]):
+        return None
+    if network.is_valid_route(request["from"], request["to"], actual["items"], actual["total_time"]):
+        return "tie"
+    return "items are not a valid route"
+
+
+def run(command, input_text):
+    result = subprocess.run(command, input=input_text, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError("%s failed: %s" % (" ".join(command), result.stderr.strip()))
+    return result.stdout
+
+
+def run_example(binary, document, use_snapshot):
+    if not use_snapshot:
+        return run([binary], json.dumps(document))
+    with tempfile.TemporaryDirectory() as directory:
+        document = dict(document)
+        document["serialization_settings"] = {"file": os.path.join(directory, "base.db")}
+        base = {key: value for key, value in document.items() if key != "stat_requests"}
+        stat = {"serialization_settings": document["serialization_settings"],
+                "stat_requests": document["stat_requests"]}
+        run([binary, "make_base"], json.dumps(base))
+        return run([binary, "process_requests"], json.dumps(stat))
+
+
+def main():
+    args = [arg for arg in sys.argv[1:] if not arg.startswith("--")]
+    if len(args) != 1:
+        print(__doc__.strip().splitlines()[2].strip(), file=sys.stderr)
+        return 2
+    binary = os.path.abspath(args[0])
+    use_snapshot = "--snapshot" in sys.argv[1:]
+
+    failed = 0
+    for name, input_file, output_file in find_examples():
+        with open(input_file) as stream:
+            document = json.load(stream)
+        with open(output_file) as stream:
+            expected = json.load(stream)
+        network = Network(document)
+        requests = {request["id"]: request for request in document["stat_requests"]}
+        for mode in ROUTER_MODES:
+            document["routing_settings"]["router_mode"] = mode
+            actual = json.loads(run_example(binary, document, use_snapshot))
+            errors = []
+            ties = 0
+            if len(actual) != len(expected):
+                errors.append("%d responses, expected %d" % (len(actual), len(expected)))
+            for actual_response, expected_response in zip(actual, expected):
+                request = requests[expected_response["request_id"]]
+                result = compare_response(request, actual_response, expected_response, network)
+                if result == "tie":
+                    ties += 1
+                elif result is not None:
+                    errors.append("request %d: %s" % (request["id"], result))
+            status = "ok" if not errors else "FAILED"
+            print("%-10s %-24s %s: %d responses, %d equal-time route ties"
+                  % (name, mode, status, len(actual), ties))
+            for error in errors[:5]:
+                print("    " + error)
+            failed += bool(errors)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Запись и чтение простых значений, векторов и строк в двоичном виде (порядок байт - платформы)
+namespace binary_io {
+
+class ReadError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+template <typename T>
+void Write(std::ostream& output, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be written");
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T Read(std::istream& input) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be read");
+    T value;
+    if (!input.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw ReadError("unexpected end of binary data");
+    }
+    return value;
+}
+
+// Читает длину вектора или строки из element_size-байтных элементов. Длина сверяется
+// с числом байт, оставшихся в буфере потока, до выделения памяти: испорченный префикс
+// не должен приводить к огромному выделению
+inline uint64_t ReadLength(std::istream& input, size_t element_size) {
+    const uint64_t length = Read<uint64_t>(input);
+    // in_avail() < 0 - данных в потоке больше нет
+    const std::streamsize available = std::max<std::streamsize>(input.rdbuf()->in_avail(), 0);
+    if (length > static_cast<uint64_t>(available) / element_size) {
+        throw ReadError("length exceeds the remaining binary data");
+    }
+    return length;
+}
+
+template <typename T>
+void WriteVector(std::ostream& output, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be written");
+    Write<uint64_t>(output, values.size());
+    output.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <typename T>
+std::vector<T> ReadVector(std::istream& input) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be read");
+    std::vector<T> values(ReadLength(input, sizeof(T)));
+    if (!input.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T))) {
+        throw ReadError("unexpected end of binary data");
+    }
+    return values;
+}
+
+inline void WriteString(std::ostream& output, std::string_view value) {
+    Write<uint64_t>(output, value.size());
+    output.write(value.data(), value.size());
+}
+
+inline std::string ReadString(std::istream& input) {
+    std::string value(ReadLength(input, 1), '\0');
+    if (!input.read(value.data(), value.size())) {
+        throw ReadError("unexpected end of binary data");
+    }
+    return value;
+}
+
+// Буфер чтения поверх готового участка памяти (например, отображенного файла) без копирования
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const char* begin, const char* end) {
+        char* const data = const_cast<char*>(begin);
+        setg(data, data, data + (end - begin));
+    }
+};
+
+}  // namespace binary_io
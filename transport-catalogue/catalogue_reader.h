@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "domain.h"
+#include "geo.h"
+#include "ranges.h"
+#include "stop_index.h"
+
+namespace t_c {
+
+using IdRange = ranges::Range<const uint32_t*>;
+using TimeRange = ranges::Range<const double*>;
+using DistanceRange = ranges::Range<const double*>;
+
+struct StopView {
+    uint32_t id;
+    std::string_view name;
+    geo::Coordinates coordinates;
+};
+
+struct BusView {
+    uint32_t id;
+    std::string_view name;
+    bool is_roundtrip;
+    // остановки развернутого маршрута, как в domain::Bus::route
+    IdRange route;
+    // 0 - скорость из настроек маршрутизации
+    double velocity;
+    TimeRange departures;
+};
+
+// Длины маршрута нарастающим итогом по позициям BusView::route, первая - 0: дорожная
+// в направлении маршрута, дорожная в обратном направлении (от каждой остановки к
+// предыдущей) и географическая. Длина отрезка маршрута - разность двух элементов
+struct RouteLengths {
+    DistanceRange road;
+    DistanceRange reverse_road;
+    DistanceRange geo;
+};
+
+// Справочник для ответов на запросы, только чтение: остановки и автобусы адресуются
+// номерами подряд с 0. Реализуют TransportCatalogue (справочник в памяти процесса)
+// и CatalogueView (образ из снимка базы, читаемый на месте). Имена и диапазоны
+// действительны, пока справочник жив и не изменился
+class CatalogueReader {
+public:
+    virtual ~CatalogueReader() = default;
+
+    virtual size_t GetStopsCount() const = 0;
+    virtual size_t GetBusesCount() const = 0;
+    // номер вне справочника - std::out_of_range
+    virtual StopView GetStop(uint32_t id) const = 0;
+    virtual BusView GetBus(uint32_t id) const = 0;
+    virtual std::optional<uint32_t> FindStopId(std::string_view name) const = 0;
+    virtual std::optional<uint32_t> FindBusId(std::string_view name) const = 0;
+
+    // номера всех остановок и всех автобусов по возрастанию имени
+    virtual IdRange GetStopsByName() const = 0;
+    virtual IdRange GetBusesByName() const = 0;
+    // номера автобусов через остановку по возрастанию имени
+    virtual IdRange GetStopBuses(uint32_t stop_id) const = 0;
+
+    // заданное расстояние, при отсутствии - обратное. Если не найдено: -1
+    virtual double FindDistance(uint32_t from_id, uint32_t to_id) const = 0;
+    virtual RouteLengths GetBusRouteLengths(uint32_t bus_id) const = 0;
+    virtual domain::BusStat GetBusStat(uint32_t bus_id) const = 0;
+
+    // пространственный индекс всех остановок
+    virtual const StopIndex& GetStopIndex() const = 0;
+
+    // Версия содержимого: меняется при каждом изменении справочника и не повторяется
+    // у разных справочников. По ней сбрасываются производные кеши
+    virtual uint64_t GetVersion() const = 0;
+};
+
+// номера версий общие для всех справочников, поэтому не повторяются между ними
+inline uint64_t NextCatalogueVersion() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
+} // t_c
@@ -0,0 +1,342 @@
+#include "catalogue_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+using namespace domain;
+
+namespace t_c {
+
+namespace {
+
+const size_t ALIGNMENT = sizeof(uint64_t);
+
+uint32_t CheckedId(size_t value) {
+    if (value > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("catalogue is too large for the snapshot");
+    }
+    return static_cast<uint32_t>(value);
+}
+
+// массивы образа, пока он собирается: каждый ляжет в образ с выравниванием
+struct ImageParts {
+    std::vector<flat::StopRecord> stops;
+    std::vector<flat::BusRecord> buses;
+    std::vector<uint32_t> route_stops;
+    std::vector<double> route_road;
+    std::vector<double> route_reverse_road;
+    std::vector<double> route_geo;
+    std::vector<double> departures;
+    std::vector<uint32_t> stop_buses;
+    std::vector<uint32_t> stops_by_name;
+    std::vector<uint32_t> buses_by_name;
+    std::vector<flat::DistanceRecord> distances;
+    std::string strings;
+};
+
+template <typename T, typename Range>
+void Append(std::vector<T>& values, const Range& range) {
+    values.insert(values.end(), range.begin(), range.end());
+}
+
+} // namespace
+
+std::vector<uint64_t> MakeCatalogueImage(const TransportCatalogue& catalogue) {
+    ImageParts parts;
+
+    const auto add_string = [&parts](std::string_view str) {
+        const uint32_t offset = CheckedId(parts.strings.size());
+        parts.strings += str;
+        CheckedId(parts.strings.size());
+        return offset;
+    };
+
+    // автобусы остановок и номера по именам уже упорядочены справочником
+    parts.stops.reserve(catalogue.GetStopsCount());
+    for (uint32_t id = 0; id < catalogue.GetStopsCount(); ++id) {
+        const StopView stop = catalogue.GetStop(id);
+        const uint32_t buses_begin = CheckedId(parts.stop_buses.size());
+        Append(parts.stop_buses, catalogue.GetStopBuses(id));
+        parts.stops.push_back({stop.coordinates.lat, stop.coordinates.lng,
+                               add_string(stop.name), CheckedId(stop.name.size()),
+                               buses_begin, CheckedId(parts.stop_buses.size())});
+    }
+
+    parts.buses.reserve(catalogue.GetBusesCount());
+    for (uint32_t id = 0; id < catalogue.GetBusesCount(); ++id) {
+        const BusView bus = catalogue.GetBus(id);
+        const uint32_t route_begin = CheckedId(parts.route_stops.size());
+        Append(parts.route_stops, bus.route);
+        const RouteLengths lengths = catalogue.GetBusRouteLengths(id);
+        Append(parts.route_road, lengths.road);
+        Append(parts.route_reverse_road, lengths.reverse_road);
+        Append(parts.route_geo, lengths.geo);
+        const uint32_t departures_begin = CheckedId(parts.departures.size());
+        Append(parts.departures, bus.departures);
+        parts.buses.push_back({add_string(bus.name), CheckedId(bus.name.size()),
+                               route_begin, CheckedId(parts.route_stops.size()),
+                               bus.is_roundtrip ? 1u : 0u,
+                               departures_begin, CheckedId(parts.departures.size()),
+                               CheckedId(catalogue.GetBusStat(id).unique_count), bus.velocity});
+    }
+
+    Append(parts.stops_by_name, catalogue.GetStopsByName());
+    Append(parts.buses_by_name, catalogue.GetBusesByName());
+
+    for (const auto& [from, to, distance] : catalogue.GetDistances().GetItems()) {
+        parts.distances.push_back({from, to, distance});
+    }
+    std::sort(parts.distances.begin(), parts.distances.end(),
+        [](const flat::DistanceRecord& lhs, const flat::DistanceRecord& rhs) {
+            return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+        });
+
+    // раскладываем массивы друг за другом после заголовка, выравнивая начало каждого
+    flat::Header header{};
+    uint64_t image_size = sizeof(flat::Header);
+    const auto place = [&image_size](size_t bytes) {
+        image_size = (image_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        const uint64_t offset = image_size;
+        image_size += bytes;
+        return offset;
+    };
+    header.stops_offset = place(parts.stops.size() * sizeof(flat::StopRecord));
+    header.stops_count = parts.stops.size();
+    header.buses_offset = place(parts.buses.size() * sizeof(flat::BusRecord));
+    header.buses_count = parts.buses.size();
+    header.route_stops_offset = place(parts.route_stops.size() * sizeof(uint32_t));
+    header.route_stops_count = parts.route_stops.size();
+    header.route_road_offset = place(parts.route_road.size() * sizeof(double));
+    header.route_reverse_road_offset = place(parts.route_reverse_road.size() * sizeof(double));
+    header.route_geo_offset = place(parts.route_geo.size() * sizeof(double));
+    header.departures_offset = place(parts.departures.size() * sizeof(double));
+    header.departures_count = parts.departures.size();
+    header.stop_buses_offset = place(parts.stop_buses.size() * sizeof(uint32_t));
+    header.stop_buses_count = parts.stop_buses.size();
+    header.stops_by_name_offset = place(parts.stops_by_name.size() * sizeof(uint32_t));
+    header.buses_by_name_offset = place(parts.buses_by_name.size() * sizeof(uint32_t));
+    header.distances_offset = place(parts.distances.size() * sizeof(flat::DistanceRecord));
+    header.distances_count = parts.distances.size();
+    header.strings_offset = place(parts.strings.size());
+    header.strings_size = parts.strings.size();
+    header.image_size = image_size;
+
+    std::vector<uint64_t> image((image_size + ALIGNMENT - 1) / ALIGNMENT, 0);
+    char* const data = reinterpret_cast<char*>(image.data());
+    std::memcpy(data, &header, sizeof(header));
+    const auto copy = [data](uint64_t offset, const auto& values) {
+        if (!values.empty()) {
+            std::memcpy(data + offset, values.data(), values.size() * sizeof(values[0]));
+        }
+    };
+    copy(header.stops_offset, parts.stops);
+    copy(header.buses_offset, parts.buses);
+    copy(header.route_stops_offset, parts.route_stops);
+    copy(header.route_road_offset, parts.route_road);
+    copy(header.route_reverse_road_offset, parts.route_reverse_road);
+    copy(header.route_geo_offset, parts.route_geo);
+    copy(header.departures_offset, parts.departures);
+    copy(header.stop_buses_offset, parts.stop_buses);
+    copy(header.stops_by_name_offset, parts.stops_by_name);
+    copy(header.buses_by_name_offset, parts.buses_by_name);
+    copy(header.distances_offset, parts.distances);
+    copy(header.strings_offset, parts.strings);
+    return image;
+}
+
+/* ---------------- CatalogueView ---------------- */
+CatalogueView::CatalogueView(const void* data, size_t size)
+    : data_(static_cast<const char*>(data)) {
+    if (size < sizeof(flat::Header) || reinterpret_cast<uintptr_t>(data_) % ALIGNMENT != 0) {
+        throw std::invalid_argument("catalogue image: wrong size or alignment");
+    }
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (header_.image_size > size) {
+        throw std::invalid_argument("catalogue image: truncated");
+    }
+    stops_ = GetArray<flat::StopRecord>(header_.stops_offset, header_.stops_count);
+    buses_ = GetArray<flat::BusRecord>(header_.buses_offset, header_.buses_count);
+    route_stops_ = GetArray<uint32_t>(header_.route_stops_offset, header_.route_stops_count);
+    route_road_ = GetArray<double>(header_.route_road_offset, header_.route_stops_count);
+    route_reverse_road_ = GetArray<double>(header_.route_reverse_road_offset, header_.route_stops_count);
+    route_geo_ = GetArray<double>(header_.route_geo_offset, header_.route_stops_count);
+    departures_ = GetArray<double>(header_.departures_offset, header_.departures_count);
+    stop_buses_ = GetArray<uint32_t>(header_.stop_buses_offset, header_.stop_buses_count);
+    stops_by_name_ = GetArray<uint32_t>(header_.stops_by_name_offset, header_.stops_count);
+    buses_by_name_ = GetArray<uint32_t>(header_.buses_by_name_offset, header_.buses_count);
+    distances_ = GetArray<flat::DistanceRecord>(header_.distances_offset, header_.distances_count);
+    strings_ = GetArray<char>(header_.strings_offset, header_.strings_size);
+
+    // ссылки внутри образа проверяются один раз, чтобы запросы обходились без проверок
+    const auto check = [](bool is_valid) {
+        if (!is_valid) {
+            throw std::invalid_argument("catalogue image: broken reference");
+        }
+    };
+    const auto is_valid_string = [this](uint32_t offset, uint32_t size) {
+        return offset <= header_.strings_size && size <= header_.strings_size - offset;
+    };
+    for (size_t id = 0; id < header_.stops_count; ++id) {
+        const flat::StopRecord& stop = stops_[id];
+        check(is_valid_string(stop.name_offset, stop.name_size));
+        check(stop.buses_begin <= stop.buses_end && stop.buses_end <= header_.stop_buses_count);
+        check(stops_by_name_[id] < header_.stops_count);
+    }
+    for (size_t id = 0; id < header_.buses_count; ++id) {
+        const flat::BusRecord& bus = buses_[id];
+        check(is_valid_string(bus.name_offset, bus.name_size));
+        check(bus.route_begin <= bus.route_end && bus.route_end <= header_.route_stops_count);
+        check(bus.departures_begin <= bus.departures_end && bus.departures_end <= header_.departures_count);
+        check(bus.unique_stops_count <= bus.route_end - bus.route_begin);
+        check(buses_by_name_[id] < header_.buses_count);
+    }
+    for (size_t i = 0; i < header_.route_stops_count; ++i) {
+        check(route_stops_[i] < header_.stops_count);
+    }
+    for (size_t i = 0; i < header_.stop_buses_count; ++i) {
+        check(stop_buses_[i] < header_.buses_count);
+    }
+    for (size_t i = 0; i < header_.distances_count; ++i) {
+        check(distances_[i].from < header_.stops_count && distances_[i].to < header_.stops_count);
+    }
+}
+
+template <typename T>
+const T* CatalogueView::GetArray(uint64_t offset, uint64_t count) const {
+    if (offset % alignof(T) != 0 || offset > header_.image_size
+        || count > (header_.image_size - offset) / sizeof(T)) {
+        throw std::invalid_argument("catalogue image: array out of bounds");
+    }
+    return reinterpret_cast<const T*>(data_ + offset);
+}
+
+std::string_view CatalogueView::GetString(uint32_t offset, uint32_t size) const {
+    return {strings_ + offset, size};
+}
+
+size_t CatalogueView::GetStopsCount() const {
+    return header_.stops_count;
+}
+
+size_t CatalogueView::GetBusesCount() const {
+    return header_.buses_count;
+}
+
+StopView CatalogueView::GetStop(uint32_t id) const {
+    if (id >= header_.stops_count) {
+        throw std::out_of_range("unknown stop");
+    }
+    const flat::StopRecord& stop = stops_[id];
+    return {id, GetString(stop.name_offset, stop.name_size), {stop.lat, stop.lng}};
+}
+
+BusView CatalogueView::GetBus(uint32_t id) const {
+    if (id >= header_.buses_count) {
+        throw std::out_of_range("unknown bus");
+    }
+    const flat::BusRecord& bus = buses_[id];
+    return {id, GetString(bus.name_offset, bus.name_size), bus.is_roundtrip != 0,
+            IdRange{route_stops_ + bus.route_begin, route_stops_ + bus.route_end}, bus.velocity,
+            TimeRange{departures_ + bus.departures_begin, departures_ + bus.departures_end}};
+}
+
+std::optional<uint32_t> CatalogueView::FindStopId(std::string_view name) const {
+    const uint32_t* end = stops_by_name_ + header_.stops_count;
+    const uint32_t* it = std::lower_bound(stops_by_name_, end, name, [this](uint32_t id, std::string_view value) {
+        return GetString(stops_[id].name_offset, stops_[id].name_size) < value;
+    });
+    if (it == end || GetString(stops_[*it].name_offset, stops_[*it].name_size) != name) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::optional<uint32_t> CatalogueView::FindBusId(std::string_view name) const {
+    const uint32_t* end = buses_by_name_ + header_.buses_count;
+    const uint32_t* it = std::lower_bound(buses_by_name_, end, name, [this](uint32_t id, std::string_view value) {
+        return GetString(buses_[id].name_offset, buses_[id].name_size) < value;
+    });
+    if (it == end || GetString(buses_[*it].name_offset, buses_[*it].name_size) != name) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+IdRange CatalogueView::GetStopsByName() const {
+    return {stops_by_name_, stops_by_name_ + header_.stops_count};
+}
+
+IdRange CatalogueView::GetBusesByName() const {
+    return {buses_by_name_, buses_by_name_ + header_.buses_count};
+}
+
+IdRange CatalogueView::GetStopBuses(uint32_t stop_id) const {
+    if (stop_id >= header_.stops_count) {
+        throw std::out_of_range("unknown stop");
+    }
+    const flat::StopRecord& stop = stops_[stop_id];
+    return {stop_buses_ + stop.buses_begin, stop_buses_ + stop.buses_end};
+}
+
+double CatalogueView::FindDistance(uint32_t from_id, uint32_t to_id) const {
+    const flat::DistanceRecord* end = distances_ + header_.distances_count;
+    const auto find = [this, end](uint32_t first, uint32_t second) {
+        const flat::DistanceRecord* it = std::lower_bound(distances_, end, std::pair{first, second},
+            [](const flat::DistanceRecord& record, const std::pair<uint32_t, uint32_t>& value) {
+                return std::pair{record.from, record.to} < value;
+            });
+        return it != end && it->from == first && it->to == second ? it : nullptr;
+    };
+    if (const flat::DistanceRecord* distance = find(from_id, to_id)) {
+        return distance->distance;
+    }
+    if (const flat::DistanceRecord* reverse_distance = find(to_id, from_id)) {
+        return reverse_distance->distance;
+    }
+    return -1;
+}
+
+RouteLengths CatalogueView::GetBusRouteLengths(uint32_t bus_id) const {
+    if (bus_id >= header_.buses_count) {
+        throw std::out_of_range("unknown bus");
+    }
+    const flat::BusRecord& bus = buses_[bus_id];
+    const auto make_range = [&bus](const double* lengths) {
+        return DistanceRange{lengths + bus.route_begin, lengths + bus.route_end};
+    };
+    return {make_range(route_road_), make_range(route_reverse_road_), make_range(route_geo_)};
+}
+
+BusStat CatalogueView::GetBusStat(uint32_t bus_id) const {
+    const BusView bus = GetBus(bus_id);
+    const RouteLengths lengths = GetBusRouteLengths(bus_id);
+    // полные длины - последние элементы нарастающих итогов, как в TransportCatalogue
+    const double length = bus.route.empty() ? 0 : *(lengths.road.end() - 1);
+    const double geographical_length = bus.route.empty() ? 0 : *(lengths.geo.end() - 1);
+    return BusStat{bus.name, static_cast<int>(bus.route.size()),
+                   static_cast<int>(buses_[bus_id].unique_stops_count),
+                   length, length / geographical_length};
+}
+
+const StopIndex& CatalogueView::GetStopIndex() const {
+    std::lock_guard guard(stop_index_mutex_);
+    if (!stop_index_) {
+        std::vector<StopIndex::Item> items;
+        items.reserve(header_.stops_count);
+        for (uint32_t id = 0; id < header_.stops_count; ++id) {
+            const StopView stop = GetStop(id);
+            items.push_back({stop.coordinates, id, stop.name});
+        }
+        stop_index_ = std::make_unique<StopIndex>(std::move(items));
+    }
+    return *stop_index_;
+}
+
+uint64_t CatalogueView::GetVersion() const {
+    return version_;
+}
+
+} // t_c
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalogue_reader.h"
+#include "domain.h"
+#include "geo.h"
+#include "stop_index.h"
+#include "transport_catalogue.h"
+
+namespace t_c {
+
+// Плоская раскладка справочника для снимка базы. Все массивы выровнены и адресуются
+// смещениями от начала образа, поэтому образ можно отобразить в память (mmap) и читать
+// на месте: несколько процессов делят одни и те же физические страницы
+namespace flat {
+
+struct Header {
+    uint64_t image_size;
+    uint64_t stops_offset;
+    uint64_t stops_count;
+    uint64_t buses_offset;
+    uint64_t buses_count;
+    // номера остановок маршрутов подряд; маршрут автобуса - отрезок [route_begin, route_end)
+    uint64_t route_stops_offset;
+    uint64_t route_stops_count;
+    // длины маршрутов нарастающим итогом (см. RouteLengths), по позициям route_stops
+    uint64_t route_road_offset;
+    uint64_t route_reverse_road_offset;
+    uint64_t route_geo_offset;
+    // номера автобусов остановок подряд, по возрастанию имени автобуса
+    uint64_t stop_buses_offset;
+    uint64_t stop_buses_count;
+    // номера остановок и автобусов по возрастанию имени - индекс для двоичного поиска
+    uint64_t stops_by_name_offset;
+    uint64_t buses_by_name_offset;
+    // отправления рейсов автобусов подряд; расписание автобуса - отрезок [departures_begin, departures_end)
+    uint64_t departures_offset;
+    uint64_t departures_count;
+    // расстояния по возрастанию пары (from, to)
+    uint64_t distances_offset;
+    uint64_t distances_count;
+    // имена всех остановок и автобусов подряд
+    uint64_t strings_offset;
+    uint64_t strings_size;
+};
+
+struct StopRecord {
+    double lat;
+    double lng;
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t buses_begin;
+    uint32_t buses_end;
+};
+
+struct BusRecord {
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t route_begin;
+    uint32_t route_end;
+    uint32_t is_roundtrip;
+    uint32_t departures_begin;
+    uint32_t departures_end;
+    // число разных остановок маршрута для статистики автобуса
+    uint32_t unique_stops_count;
+    double velocity;
+};
+
+struct DistanceRecord {
+    uint32_t from;
+    uint32_t to;
+    double distance;
+};
+
+} // namespace flat
+
+// Строит плоский образ справочника. Остановки и автобусы сохраняют номера справочника;
+// по ним к ним обращаются остальные части снимка
+std::vector<uint64_t> MakeCatalogueImage(const TransportCatalogue& catalogue);
+
+// Справочник поверх плоского образа без копирования и разбора: данные не принадлежат
+// представлению и должны жить дольше него. Границы массивов проверяются при создании.
+// Запросы читают образ на месте; в памяти процесса строится только индекс остановок,
+// при первом обращении к нему
+class CatalogueView : public CatalogueReader {
+public:
+    CatalogueView(const void* data, size_t size);
+
+    size_t GetStopsCount() const override;
+    size_t GetBusesCount() const override;
+    StopView GetStop(uint32_t id) const override;
+    BusView GetBus(uint32_t id) const override;
+    // двоичный поиск по упорядоченным по имени номерам
+    std::optional<uint32_t> FindStopId(std::string_view name) const override;
+    std::optional<uint32_t> FindBusId(std::string_view name) const override;
+
+    IdRange GetStopsByName() const override;
+    IdRange GetBusesByName() const override;
+    IdRange GetStopBuses(uint32_t stop_id) const override;
+
+    double FindDistance(uint32_t from_id, uint32_t to_id) const override;
+    RouteLengths GetBusRouteLengths(uint32_t bus_id) const override;
+    domain::BusStat GetBusStat(uint32_t bus_id) const override;
+
+    const StopIndex& GetStopIndex() const override;
+    // образ не меняется: версия одна на все время жизни
+    uint64_t GetVersion() const override;
+
+private:
+    template <typename T>
+    const T* GetArray(uint64_t offset, uint64_t count) const;
+    std::string_view GetString(uint32_t offset, uint32_t size) const;
+
+    const char* data_;
+    flat::Header header_;
+    const flat::StopRecord* stops_;
+    const flat::BusRecord* buses_;
+    const uint32_t* route_stops_;
+    const double* route_road_;
+    const double* route_reverse_road_;
+    const double* route_geo_;
+    const double* departures_;
+    const uint32_t* stop_buses_;
+    const uint32_t* stops_by_name_;
+    const uint32_t* buses_by_name_;
+    const flat::DistanceRecord* distances_;
+    const char* strings_;
+    const uint64_t version_ = NextCatalogueVersion();
+
+    mutable std::unique_ptr<StopIndex> stop_index_;
+    mutable std::mutex stop_index_mutex_;
+};
+
+} // t_c
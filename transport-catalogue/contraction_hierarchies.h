@@ -0,0 +1,578 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархии сжатия (contraction hierarchies): вершины графа по очереди "сжимаются",
+// а кратчайшие пути через сжатую вершину заменяются шорткатами. Запрос - двунаправленный
+// Дейкстра, который идет только вверх по иерархии, поэтому просматривает малую часть графа.
+// Шорткаты раскрываются обратно в исходные ребра графа.
+template <typename Weight>
+class ContractionHierarchiesRouter final : public Router<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename Router<Weight>::RouteInfo;
+    using typename Router<Weight>::Terminal;
+    using typename Router<Weight>::BestRouteInfo;
+
+    explicit ContractionHierarchiesRouter(const Graph& graph);
+    ContractionHierarchiesRouter(const Graph& graph, std::istream& input);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // тот же двунаправленный поиск: прямой начинается из всех начал, обратный - из всех концов
+    std::optional<BestRouteInfo> BuildBestRoute(const std::vector<Terminal>& sources,
+                                                const std::vector<Terminal>& targets) const override;
+
+    // сохраняются ребра иерархии и ранги вершин, графы поиска строятся по ним при загрузке
+    void Save(std::ostream& output) const override;
+
+private:
+    using HierarchyEdgeId = size_t;
+    static constexpr HierarchyEdgeId NO_EDGE = std::numeric_limits<HierarchyEdgeId>::max();
+
+    // ребро иерархии: исходное ребро графа либо шорткат из двух ребер иерархии
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId graph_edge;
+        HierarchyEdgeId first_half = NO_EDGE;
+        HierarchyEdgeId second_half = NO_EDGE;
+
+        bool IsShortcut() const {
+            return first_half != NO_EDGE;
+        }
+    };
+
+    struct RouteInternalData {
+        Weight weight;
+        HierarchyEdgeId prev_edge = NO_EDGE;
+    };
+    using RoutesInternalData = std::vector<std::optional<RouteInternalData>>;
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // данные, нужные только на время предподсчета. В списках смежности - только ребра
+    // между еще не сжатыми вершинами: при сжатии вершины ее ребра удаляются из списков
+    // соседей, а из параллельных ребер остается самое легкое
+    struct Preprocessing {
+        std::vector<std::vector<HierarchyEdgeId>> out_edges;
+        std::vector<std::vector<HierarchyEdgeId>> in_edges;
+        std::vector<int> contracted_neighbours;
+        // расстояния поиска свидетелей и список затронутых вершин для быстрой очистки
+        std::vector<std::optional<Weight>> witness_weights;
+        std::vector<VertexId> witness_touched;
+        // куча поиска свидетелей, память переиспользуется между поисками
+        std::vector<QueueItem> witness_queue;
+        // концы исходящих ребер сжимаемой вершины: поиск свидетелей заканчивается,
+        // когда все они просмотрены
+        std::vector<bool> is_witness_target;
+    };
+
+    // предельное число вершин, просматриваемых при поиске свидетеля
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 50;
+
+    void InitializeHierarchyEdges(const Graph& graph, Preprocessing& data);
+    void ContractVertices(Preprocessing& data);
+    void BuildSearchGraphs();
+
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight,
+                          size_t target_count, Preprocessing& data) const;
+    int ProcessVertex(VertexId vertex, bool add_shortcuts, Preprocessing& data);
+    int ComputePriority(VertexId vertex, Preprocessing& data);
+    HierarchyEdgeId AddHierarchyEdge(HierarchyEdge edge, Preprocessing& data);
+    // шорткат не добавляется, если между его концами уже есть ребро не тяжелее,
+    // а более тяжелое ребро убирается из списков смежности
+    void AddShortcut(HierarchyEdge shortcut, Preprocessing& data);
+    // убирает сжатую вершину из списков смежности соседей
+    void RemoveContractedVertex(VertexId vertex, Preprocessing& data);
+
+    // поиск от вершин, уже положенных в очереди; возвращает вес лучшего пути и вершину встречи
+    std::optional<std::pair<Weight, VertexId>> RunSearch(RoutesInternalData& forward_data,
+                                                         RoutesInternalData& backward_data,
+                                                         Queue& forward_queue,
+                                                         Queue& backward_queue) const;
+    // раскрывает путь через вершину встречи в ребра графа
+    std::vector<EdgeId> ExtractEdges(const RoutesInternalData& forward_data,
+                                     const RoutesInternalData& backward_data,
+                                     VertexId meeting_vertex) const;
+
+    void UnpackEdge(HierarchyEdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> ranks_;
+    // ребра поиска вперед: ведут из вершины в вершину с большим рангом
+    std::vector<std::vector<HierarchyEdgeId>> upward_edges_;
+    // ребра поиска назад: входят в вершину из вершины с большим рангом
+    std::vector<std::vector<HierarchyEdgeId>> downward_edges_;
+};
+
+template <typename Weight>
+ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph)
+    : ranks_(graph.GetVertexCount())
+    , upward_edges_(graph.GetVertexCount())
+    , downward_edges_(graph.GetVertexCount())
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    Preprocessing data{
+        std::vector<std::vector<HierarchyEdgeId>>(vertex_count),
+        std::vector<std::vector<HierarchyEdgeId>>(vertex_count),
+        std::vector<int>(vertex_count, 0),
+        std::vector<std::optional<Weight>>(vertex_count),
+        {},
+        {},
+        std::vector<bool>(vertex_count, false)
+    };
+    InitializeHierarchyEdges(graph, data);
+    ContractVertices(data);
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph, std::istream& input)
+    : edges_(binary_io::ReadVector<HierarchyEdge>(input))
+    , ranks_(binary_io::ReadVector<size_t>(input))
+    , upward_edges_(graph.GetVertexCount())
+    , downward_edges_(graph.GetVertexCount())
+{
+    if (ranks_.size() != graph.GetVertexCount()) {
+        throw binary_io::ReadError("hierarchy doesn't match the graph");
+    }
+    for (const HierarchyEdge& edge : edges_) {
+        if (edge.from >= ranks_.size() || edge.to >= ranks_.size()) {
+            throw binary_io::ReadError("hierarchy edge refers to a missing vertex");
+        }
+        const bool is_valid_edge = edge.IsShortcut()
+            ? edge.first_half < edges_.size() && edge.second_half < edges_.size()
+            : edge.graph_edge < graph.GetEdgeCount();
+        if (!is_valid_edge) {
+            throw binary_io::ReadError("hierarchy edge refers to a missing edge");
+        }
+    }
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::Save(std::ostream& output) const {
+    binary_io::WriteVector(output, edges_);
+    binary_io::WriteVector(output, ranks_);
+}
+
+template <typename Weight>
+typename ContractionHierarchiesRouter<Weight>::HierarchyEdgeId
+ContractionHierarchiesRouter<Weight>::AddHierarchyEdge(HierarchyEdge edge, Preprocessing& data) {
+    edges_.push_back(std::move(edge));
+    const HierarchyEdgeId id = edges_.size() - 1;
+    data.out_edges[edges_.back().from].push_back(id);
+    data.in_edges[edges_.back().to].push_back(id);
+    return id;
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::AddShortcut(HierarchyEdge shortcut, Preprocessing& data) {
+    std::vector<HierarchyEdgeId>& from_edges = data.out_edges[shortcut.from];
+    const auto parallel = std::find_if(from_edges.begin(), from_edges.end(),
+        [this, &shortcut](HierarchyEdgeId edge_id) { return edges_[edge_id].to == shortcut.to; });
+    if (parallel != from_edges.end()) {
+        if (!(shortcut.weight < edges_[*parallel].weight)) {
+            return;
+        }
+        // само ребро остается в edges_: на него могут ссылаться другие шорткаты
+        std::vector<HierarchyEdgeId>& to_edges = data.in_edges[shortcut.to];
+        to_edges.erase(std::find(to_edges.begin(), to_edges.end(), *parallel));
+        from_edges.erase(parallel);
+    }
+    AddHierarchyEdge(std::move(shortcut), data);
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::RemoveContractedVertex(VertexId vertex, Preprocessing& data) {
+    const auto remove_edge = [](std::vector<HierarchyEdgeId>& edges, HierarchyEdgeId edge_id) {
+        edges.erase(std::find(edges.begin(), edges.end(), edge_id));
+    };
+    for (const HierarchyEdgeId edge_id : data.in_edges[vertex]) {
+        const VertexId neighbour = edges_[edge_id].from;
+        remove_edge(data.out_edges[neighbour], edge_id);
+        ++data.contracted_neighbours[neighbour];
+    }
+    for (const HierarchyEdgeId edge_id : data.out_edges[vertex]) {
+        const VertexId neighbour = edges_[edge_id].to;
+        remove_edge(data.in_edges[neighbour], edge_id);
+        ++data.contracted_neighbours[neighbour];
+    }
+    std::vector<HierarchyEdgeId>().swap(data.in_edges[vertex]);
+    std::vector<HierarchyEdgeId>().swap(data.out_edges[vertex]);
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::InitializeHierarchyEdges(const Graph& graph,
+                                                                    Preprocessing& data) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<EdgeId> lightest_edges;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        // из параллельных ребер нужно только самое легкое, петли не нужны вовсе
+        lightest_edges.clear();
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.to != vertex) {
+                lightest_edges.push_back(edge_id);
+            }
+        }
+        std::sort(lightest_edges.begin(), lightest_edges.end(),
+            [&graph](EdgeId lhs, EdgeId rhs) {
+                const auto& lhs_edge = graph.GetEdge(lhs);
+                const auto& rhs_edge = graph.GetEdge(rhs);
+                return std::tie(lhs_edge.to, lhs_edge.weight, lhs)
+                     < std::tie(rhs_edge.to, rhs_edge.weight, rhs);
+            });
+        for (size_t i = 0; i < lightest_edges.size(); ++i) {
+            const auto& edge = graph.GetEdge(lightest_edges[i]);
+            if (i == 0 || graph.GetEdge(lightest_edges[i - 1]).to != edge.to) {
+                AddHierarchyEdge(HierarchyEdge{edge.from, edge.to, edge.weight, lightest_edges[i]}, data);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::RunWitnessSearch(VertexId source, VertexId excluded,
+                                                            Weight max_weight, size_t target_count,
+                                                            Preprocessing& data) const {
+    for (const VertexId vertex : data.witness_touched) {
+        data.witness_weights[vertex].reset();
+    }
+    data.witness_touched.clear();
+
+    std::vector<QueueItem>& queue = data.witness_queue;
+    const std::greater<QueueItem> compare;
+    queue.clear();
+    data.witness_weights[source] = ZERO_WEIGHT;
+    data.witness_touched.push_back(source);
+    queue.emplace_back(ZERO_WEIGHT, source);
+
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < WITNESS_SETTLE_LIMIT) {
+        std::pop_heap(queue.begin(), queue.end(), compare);
+        const auto [weight, vertex] = queue.back();
+        queue.pop_back();
+        if (weight > *data.witness_weights[vertex]) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled_count;
+        if (data.is_witness_target[vertex] && --target_count == 0) {
+            break;
+        }
+
+        for (const HierarchyEdgeId edge_id : data.out_edges[vertex]) {
+            const auto& edge = edges_[edge_id];
+            if (edge.to == excluded) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            auto& witness_weight = data.witness_weights[edge.to];
+            if (!witness_weight) {
+                data.witness_touched.push_back(edge.to);
+            }
+            if (!witness_weight || candidate_weight < *witness_weight) {
+                witness_weight = candidate_weight;
+                queue.emplace_back(candidate_weight, edge.to);
+                std::push_heap(queue.begin(), queue.end(), compare);
+            }
+        }
+    }
+}
+
+// Возвращает число шорткатов, которые нужны при сжатии вершины, и при необходимости добавляет их
+template <typename Weight>
+int ContractionHierarchiesRouter<Weight>::ProcessVertex(VertexId vertex, bool add_shortcuts,
+                                                        Preprocessing& data) {
+    int shortcut_count = 0;
+    // список входящих ребер может пополниться шорткатами, поэтому обходим его по индексу
+    const size_t in_edge_count = data.in_edges[vertex].size();
+    for (size_t i = 0; i < in_edge_count; ++i) {
+        const HierarchyEdge in_edge = edges_[data.in_edges[vertex][i]];
+
+        std::optional<Weight> max_weight;
+        size_t target_count = 0;
+        for (const HierarchyEdgeId out_edge_id : data.out_edges[vertex]) {
+            const auto& out_edge = edges_[out_edge_id];
+            if (out_edge.to == in_edge.from) {
+                continue;
+            }
+            const Weight weight = in_edge.weight + out_edge.weight;
+            if (!max_weight || *max_weight < weight) {
+                max_weight = weight;
+            }
+            data.is_witness_target[out_edge.to] = true;
+            ++target_count;
+        }
+        if (!max_weight) {
+            continue;
+        }
+
+        RunWitnessSearch(in_edge.from, vertex, *max_weight, target_count, data);
+        for (const HierarchyEdgeId out_edge_id : data.out_edges[vertex]) {
+            data.is_witness_target[edges_[out_edge_id].to] = false;
+        }
+
+        const size_t out_edge_count = data.out_edges[vertex].size();
+        for (size_t j = 0; j < out_edge_count; ++j) {
+            const HierarchyEdgeId out_edge_id = data.out_edges[vertex][j];
+            const HierarchyEdge out_edge = edges_[out_edge_id];
+            if (out_edge.to == in_edge.from) {
+                continue;
+            }
+            const Weight weight = in_edge.weight + out_edge.weight;
+            const auto& witness_weight = data.witness_weights[out_edge.to];
+            if (witness_weight && !(weight < *witness_weight)) {
+                continue;
+            }
+            ++shortcut_count;
+            if (add_shortcuts) {
+                AddShortcut(HierarchyEdge{in_edge.from, out_edge.to, weight, 0,
+                                          data.in_edges[vertex][i], out_edge_id}, data);
+            }
+        }
+    }
+    return shortcut_count;
+}
+
+// Приоритет сжатия: разность числа добавляемых и удаляемых ребер плюс число уже сжатых соседей
+template <typename Weight>
+int ContractionHierarchiesRouter<Weight>::ComputePriority(VertexId vertex, Preprocessing& data) {
+    const int removed_count = static_cast<int>(data.in_edges[vertex].size() + data.out_edges[vertex].size());
+    return ProcessVertex(vertex, false, data) - removed_count + data.contracted_neighbours[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::ContractVertices(Preprocessing& data) {
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+
+    const size_t vertex_count = ranks_.size();
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.emplace(ComputePriority(vertex, data), vertex);
+    }
+
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        // приоритеты пересчитываются лениво: если вершина подешевела не сильнее соседей - сжимаем
+        const int priority = ComputePriority(vertex, data);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.emplace(priority, vertex);
+            continue;
+        }
+
+        ProcessVertex(vertex, true, data);
+        ranks_[vertex] = next_rank++;
+        RemoveContractedVertex(vertex, data);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::BuildSearchGraphs() {
+    for (HierarchyEdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const auto& edge = edges_[edge_id];
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            upward_edges_[edge.from].push_back(edge_id);
+        } else {
+            downward_edges_[edge.to].push_back(edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchiesRouter<Weight>::UnpackEdge(HierarchyEdgeId edge_id,
+                                                      std::vector<EdgeId>& edges) const {
+    std::vector<HierarchyEdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const auto& edge = edges_[stack.back()];
+        stack.pop_back();
+        if (edge.IsShortcut()) {
+            stack.push_back(edge.second_half);
+            stack.push_back(edge.first_half);
+        } else {
+            edges.push_back(edge.graph_edge);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchiesRouter<Weight>::RouteInfo>
+ContractionHierarchiesRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = ranks_.size();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    RoutesInternalData forward_data(vertex_count);
+    RoutesInternalData backward_data(vertex_count);
+    Queue forward_queue;
+    Queue backward_queue;
+
+    forward_data[from] = RouteInternalData{ZERO_WEIGHT};
+    forward_queue.emplace(ZERO_WEIGHT, from);
+    backward_data[to] = RouteInternalData{ZERO_WEIGHT};
+    backward_queue.emplace(ZERO_WEIGHT, to);
+
+    const auto best = RunSearch(forward_data, backward_data, forward_queue, backward_queue);
+    if (!best) {
+        return std::nullopt;
+    }
+    return RouteInfo{best->first, ExtractEdges(forward_data, backward_data, best->second)};
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchiesRouter<Weight>::BestRouteInfo>
+ContractionHierarchiesRouter<Weight>::BuildBestRoute(const std::vector<Terminal>& sources,
+                                                     const std::vector<Terminal>& targets) const {
+    const size_t vertex_count = ranks_.size();
+    RoutesInternalData forward_data(vertex_count);
+    RoutesInternalData backward_data(vertex_count);
+    Queue forward_queue;
+    Queue backward_queue;
+
+    // в вершине с несколькими началами (концами) нужно только самое легкое
+    const auto seed = [vertex_count](const std::vector<Terminal>& terminals, RoutesInternalData& data,
+                                     Queue& queue) {
+        std::vector<size_t> vertex_terminals(vertex_count, terminals.size());
+        for (size_t i = 0; i < terminals.size(); ++i) {
+            const auto [vertex, weight] = terminals[i];
+            if (vertex >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            if (!data[vertex] || weight < data[vertex]->weight) {
+                data[vertex] = RouteInternalData{weight};
+                vertex_terminals[vertex] = i;
+                queue.emplace(weight, vertex);
+            }
+        }
+        return vertex_terminals;
+    };
+    const std::vector<size_t> vertex_sources = seed(sources, forward_data, forward_queue);
+    const std::vector<size_t> vertex_targets = seed(targets, backward_data, backward_queue);
+
+    const auto best = RunSearch(forward_data, backward_data, forward_queue, backward_queue);
+    if (!best) {
+        return std::nullopt;
+    }
+
+    // цепочки ребер поиска кончаются в начале и конце, с которых они начались
+    VertexId source_vertex = best->second;
+    while (forward_data[source_vertex]->prev_edge != NO_EDGE) {
+        source_vertex = edges_[forward_data[source_vertex]->prev_edge].from;
+    }
+    VertexId target_vertex = best->second;
+    while (backward_data[target_vertex]->prev_edge != NO_EDGE) {
+        target_vertex = edges_[backward_data[target_vertex]->prev_edge].to;
+    }
+    return BestRouteInfo{RouteInfo{best->first, ExtractEdges(forward_data, backward_data, best->second)},
+                         vertex_sources[source_vertex], vertex_targets[target_vertex]};
+}
+
+template <typename Weight>
+std::optional<std::pair<Weight, VertexId>> ContractionHierarchiesRouter<Weight>::RunSearch(
+                                                            RoutesInternalData& forward_data,
+                                                            RoutesInternalData& backward_data,
+                                                            Queue& forward_queue,
+                                                            Queue& backward_queue) const {
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = 0;
+
+    while (!forward_queue.empty() || !backward_queue.empty()) {
+        const bool is_forward = backward_queue.empty()
+            || (!forward_queue.empty() && forward_queue.top().first <= backward_queue.top().first);
+        Queue& queue = is_forward ? forward_queue : backward_queue;
+        RoutesInternalData& data = is_forward ? forward_data : backward_data;
+        const RoutesInternalData& opposite_data = is_forward ? backward_data : forward_data;
+
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        // обе кучи не содержат ничего легче найденного пути - он оптимален
+        if (best_weight && !(weight < *best_weight)) {
+            break;
+        }
+        if (data[vertex]->weight < weight) {
+            continue;
+        }
+
+        if (const auto& opposite = opposite_data[vertex]) {
+            const Weight total_weight = weight + opposite->weight;
+            if (!best_weight || total_weight < *best_weight) {
+                best_weight = total_weight;
+                meeting_vertex = vertex;
+            }
+        }
+
+        for (const HierarchyEdgeId edge_id : (is_forward ? upward_edges_ : downward_edges_)[vertex]) {
+            const auto& edge = edges_[edge_id];
+            const VertexId next_vertex = is_forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            auto& route_internal_data = data[next_vertex];
+            if (!route_internal_data || candidate_weight < route_internal_data->weight) {
+                route_internal_data = RouteInternalData{candidate_weight, edge_id};
+                queue.emplace(candidate_weight, next_vertex);
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    return std::pair{*best_weight, meeting_vertex};
+}
+
+template <typename Weight>
+std::vector<EdgeId> ContractionHierarchiesRouter<Weight>::ExtractEdges(
+                                                            const RoutesInternalData& forward_data,
+                                                            const RoutesInternalData& backward_data,
+                                                            VertexId meeting_vertex) const {
+    std::vector<HierarchyEdgeId> forward_edges;
+    for (HierarchyEdgeId edge_id = forward_data[meeting_vertex]->prev_edge;
+         edge_id != NO_EDGE;
+         edge_id = forward_data[edges_[edge_id].from]->prev_edge)
+    {
+        forward_edges.push_back(edge_id);
+    }
+    std::reverse(forward_edges.begin(), forward_edges.end());
+
+    std::vector<EdgeId> edges;
+    for (const HierarchyEdgeId edge_id : forward_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+    for (HierarchyEdgeId edge_id = backward_data[meeting_vertex]->prev_edge;
+         edge_id != NO_EDGE;
+         edge_id = backward_data[edges_[edge_id].to]->prev_edge)
+    {
+        UnpackEdge(edge_id, edges);
+    }
+    return edges;
+}
+
+}  // namespace graph
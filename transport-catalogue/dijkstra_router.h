@@ -0,0 +1,215 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Ищет кратчайший путь по запросу алгоритмом Дейкстры на двоичной куче:
+// построение не требует предподсчета, каждый запрос - O((V + E) log V)
+template <typename Weight>
+class DijkstraRouter final : public Router<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename Router<Weight>::RouteInfo;
+    using typename Router<Weight>::Terminal;
+    using typename Router<Weight>::BestRouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Один поиск из всех начал сразу: начала кладутся в кучу со своими весами, как будто
+    // в них ведут ребра из общей мнимой вершины. Поиск останавливается, как только
+    // в куче не осталось ничего легче лучшего найденного пути до конца с его весом
+    std::optional<BestRouteInfo> BuildBestRoute(const std::vector<Terminal>& sources,
+                                                const std::vector<Terminal>& targets) const override;
+
+    // предподсчета нет, сохранять нечего
+    void Save(std::ostream&) const override {
+    }
+
+private:
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    // вес пути до вершины и сама вершина; куча упорядочена по возрастанию веса
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    using RoutesInternalData = std::vector<std::optional<RouteInternalData>>;
+
+    void CheckVertex(VertexId vertex) const;
+    std::vector<EdgeId> ExtractEdges(const RoutesInternalData& routes_internal_data, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(
+                                                                    VertexId from, VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+
+    const size_t vertex_count = graph_.GetVertexCount();
+    RoutesInternalData routes_internal_data(vertex_count);
+    std::vector<bool> is_settled(vertex_count, false);
+    Queue queue;
+
+    routes_internal_data[from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.emplace(ZERO_WEIGHT, from);
+
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        // в куче могут остаться устаревшие записи: вершина уже достигнута дешевле
+        if (is_settled[vertex]) {
+            continue;
+        }
+        is_settled[vertex] = true;
+        if (vertex == to) {
+            break;
+        }
+
+        graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId next_vertex,
+                                                                 Weight edge_weight) {
+            if (is_settled[next_vertex]) {
+                return;
+            }
+            const Weight candidate_weight = weight + edge_weight;
+            auto& route_internal_data = routes_internal_data[next_vertex];
+            if (!route_internal_data || candidate_weight < route_internal_data->weight) {
+                route_internal_data = RouteInternalData{candidate_weight, edge_id};
+                queue.emplace(candidate_weight, next_vertex);
+            }
+        });
+    }
+
+    const auto& route_internal_data = routes_internal_data[to];
+    if (!route_internal_data) {
+        return std::nullopt;
+    }
+    return RouteInfo{route_internal_data->weight, ExtractEdges(routes_internal_data, to)};
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::BestRouteInfo> DijkstraRouter<Weight>::BuildBestRoute(
+                                                            const std::vector<Terminal>& sources,
+                                                            const std::vector<Terminal>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    RoutesInternalData routes_internal_data(vertex_count);
+    std::vector<bool> is_settled(vertex_count, false);
+    Queue queue;
+
+    // путь, начатый в вершине, стоит не меньше наименьшего веса начала в ней
+    std::vector<size_t> vertex_sources(vertex_count, sources.size());
+    for (size_t source = 0; source < sources.size(); ++source) {
+        const auto [vertex, weight] = sources[source];
+        CheckVertex(vertex);
+        auto& route_internal_data = routes_internal_data[vertex];
+        if (!route_internal_data || weight < route_internal_data->weight) {
+            route_internal_data = RouteInternalData{weight, std::nullopt};
+            vertex_sources[vertex] = source;
+            queue.emplace(weight, vertex);
+        }
+    }
+    // у вершины может быть несколько концов: нужен самый легкий
+    std::vector<size_t> vertex_targets(vertex_count, targets.size());
+    for (size_t target = 0; target < targets.size(); ++target) {
+        const VertexId vertex = targets[target].vertex;
+        CheckVertex(vertex);
+        size_t& vertex_target = vertex_targets[vertex];
+        if (vertex_target == targets.size() || targets[target].weight < targets[vertex_target].weight) {
+            vertex_target = target;
+        }
+    }
+
+    std::optional<Weight> best_weight;
+    VertexId best_vertex = 0;
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (best_weight && !(weight < *best_weight)) {
+            break;
+        }
+        if (is_settled[vertex]) {
+            continue;
+        }
+        is_settled[vertex] = true;
+        if (const size_t target = vertex_targets[vertex]; target != targets.size()) {
+            const Weight total_weight = weight + targets[target].weight;
+            if (!best_weight || total_weight < *best_weight) {
+                best_weight = total_weight;
+                best_vertex = vertex;
+            }
+        }
+
+        graph_.ForEachIncidentEdge(vertex, [&, weight = weight](EdgeId edge_id, VertexId next_vertex,
+                                                                 Weight edge_weight) {
+            if (is_settled[next_vertex]) {
+                return;
+            }
+            const Weight candidate_weight = weight + edge_weight;
+            auto& route_internal_data = routes_internal_data[next_vertex];
+            if (!route_internal_data || candidate_weight < route_internal_data->weight) {
+                route_internal_data = RouteInternalData{candidate_weight, edge_id};
+                queue.emplace(candidate_weight, next_vertex);
+            }
+        });
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges = ExtractEdges(routes_internal_data, best_vertex);
+    const VertexId source_vertex = edges.empty() ? best_vertex : graph_.GetEdge(edges.front()).from;
+    return BestRouteInfo{RouteInfo{*best_weight, std::move(edges)},
+                         vertex_sources[source_vertex], vertex_targets[best_vertex]};
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+std::vector<EdgeId> DijkstraRouter<Weight>::ExtractEdges(const RoutesInternalData& routes_internal_data,
+                                                         VertexId to) const {
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = routes_internal_data[to]->prev_edge;
+         edge_id;
+         edge_id = routes_internal_data[graph_.GetEdge(*edge_id).from]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return edges;
+}
+
+}  // namespace graph
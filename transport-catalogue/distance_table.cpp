@@ -0,0 +1,116 @@
+#include "distance_table.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace t_c {
+
+namespace {
+
+// таблица заполнена не больше чем наполовину: цепочки проб остаются короткими
+const size_t MIN_CAPACITY = 16;
+
+size_t GetCapacity(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// перемешивание splitmix64: номера остановок идут подряд, и без него
+// соседние пары попадали бы в соседние ячейки
+size_t Hash(uint32_t first, uint32_t second) {
+    uint64_t x = (static_cast<uint64_t>(first) << 32) | second;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<size_t>(x);
+}
+
+} // namespace
+
+void DistanceTable::Reserve(size_t count) {
+    if (GetCapacity(count) > slots_.size()) {
+        Rehash(GetCapacity(count));
+    }
+}
+
+void DistanceTable::Add(uint32_t from, uint32_t to, double distance) {
+    if ((used_ + 1) * 2 > slots_.size()) {
+        Rehash(GetCapacity(used_ + 1));
+    }
+    const uint32_t first = std::min(from, to);
+    const uint32_t second = std::max(from, to);
+    Slot& slot = slots_[FindSlot(first, second)];
+    if (slot.first == EMPTY) {
+        slot.first = first;
+        slot.second = second;
+        ++used_;
+    }
+    double& value = from == first ? slot.forward : slot.backward;
+    if (value == NO_DISTANCE) {
+        ++size_;
+    }
+    value = distance;
+}
+
+double DistanceTable::Find(uint32_t from, uint32_t to) const {
+    if (slots_.empty()) {
+        return NO_DISTANCE;
+    }
+    const uint32_t first = std::min(from, to);
+    const uint32_t second = std::max(from, to);
+    const Slot& slot = slots_[FindSlot(first, second)];
+    if (slot.first == EMPTY) {
+        return NO_DISTANCE;
+    }
+    const double distance = from == first ? slot.forward : slot.backward;
+    const double reverse_distance = from == first ? slot.backward : slot.forward;
+    return distance != NO_DISTANCE ? distance : reverse_distance;
+}
+
+std::vector<DistanceTable::Item> DistanceTable::GetItems() const {
+    std::vector<Item> items;
+    items.reserve(size_);
+    for (const Slot& slot : slots_) {
+        if (slot.first == EMPTY) {
+            continue;
+        }
+        if (slot.forward != NO_DISTANCE) {
+            items.push_back({slot.first, slot.second, slot.forward});
+        }
+        if (slot.backward != NO_DISTANCE) {
+            items.push_back({slot.second, slot.first, slot.backward});
+        }
+    }
+    return items;
+}
+
+size_t DistanceTable::GetSize() const {
+    return size_;
+}
+
+size_t DistanceTable::FindSlot(uint32_t first, uint32_t second) const {
+    const size_t mask = slots_.size() - 1;
+    size_t index = Hash(first, second) & mask;
+    while (slots_[index].first != EMPTY
+           && (slots_[index].first != first || slots_[index].second != second)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void DistanceTable::Rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity);
+    std::swap(slots_, old_slots);
+    for (const Slot& slot : old_slots) {
+        if (slot.first != EMPTY) {
+            slots_[FindSlot(slot.first, slot.second)] = slot;
+        }
+    }
+}
+
+} // t_c
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace t_c {
+
+// Дорожные расстояния между остановками по их номерам. Открытая адресация с линейным
+// пробированием в одном массиве: ячейка хранит неупорядоченную пару остановок и расстояния
+// в обе стороны, поэтому обратное расстояние находится тем же поиском
+class DistanceTable {
+public:
+    static constexpr double NO_DISTANCE = -1;
+
+    struct Item {
+        uint32_t from;
+        uint32_t to;
+        double distance;
+    };
+
+    // Пакетная загрузка: место под count пар выделяется сразу, и таблица
+    // не перестраивается, пока пар не больше
+    void Reserve(size_t count);
+
+    // задает расстояние от from до to; повторное задание заменяет прежнее
+    void Add(uint32_t from, uint32_t to, double distance);
+
+    // заданное расстояние от from до to, при отсутствии - обратное. Если не найдено: NO_DISTANCE
+    double Find(uint32_t from, uint32_t to) const;
+
+    // все заданные расстояния (без подстановки обратных), в порядке таблицы
+    std::vector<Item> GetItems() const;
+    size_t GetSize() const;
+
+private:
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+    // first <= second; forward - от first до second, backward - обратно
+    struct Slot {
+        uint32_t first = EMPTY;
+        uint32_t second = EMPTY;
+        double forward = NO_DISTANCE;
+        double backward = NO_DISTANCE;
+    };
+
+    // ячейка пары или пустая ячейка, где пара была бы
+    size_t FindSlot(uint32_t first, uint32_t second) const;
+    void Rehash(size_t capacity);
+
+    std::vector<Slot> slots_;
+    // занятые ячейки и заданные расстояния
+    size_t used_ = 0;
+    size_t size_ = 0;
+};
+
+} // t_c
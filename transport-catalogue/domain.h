@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <set>
 #include <string>
 #include <string_view>
@@ -10,6 +11,15 @@
 
 namespace domain {
 
+// способ поиска маршрутов: предподсчет всех пар вершин, поиск по запросу,
+// поиск по запросу на предподсчитанной иерархии сжатия или поиск по раундам
+// прямо по маршрутам автобусов, без графа
+enum class RouterMode {
+    ALL_PAIRS,
+    ON_DEMAND,
+    CONTRACTION_HIERARCHIES,
+    RAPTOR,
+};
 
 struct RoutingSettings {
     RoutingSettings() = default;
@@ -25,19 +35,33 @@ struct RoutingSettings {
     RoutingSettings& operator=(const RoutingSettings& r_settings) {
         velocity = r_settings.velocity;
         wait_time = r_settings.wait_time;
+        router_mode = r_settings.router_mode;
+        walk_velocity = r_settings.walk_velocity;
+        walk_stops_count = r_settings.walk_stops_count;
         return *this;
     }
     RoutingSettings& operator=(RoutingSettings&& r_settings) {
         velocity = std::move(r_settings.velocity);
         wait_time = std::move(r_settings.wait_time);
+        router_mode = std::move(r_settings.router_mode);
+        walk_velocity = std::move(r_settings.walk_velocity);
+        walk_stops_count = std::move(r_settings.walk_stops_count);
         return *this;
     }
     double wait_time = 0.0;
     double velocity = 0.0;
+    RouterMode router_mode = RouterMode::ALL_PAIRS;
+    // маршрут между точками: скорость пешехода в км/ч и число ближайших к каждой
+    // точке остановок, до которых можно дойти пешком
+    double walk_velocity = 5.0;
+    int walk_stops_count = 5;
 };
 
 struct Stop;
 
+// время в маршрутах и расписаниях считается в минутах
+constexpr double MINUTES_IN_DAY = 24 * 60;
+
 struct Bus {
     Bus() {}
     Bus(const std::string_view& busnm, std::vector<Stop*>& stops, bool is_round)
@@ -47,8 +71,15 @@ struct Bus {
         return name.empty();
     }
     std::string name;
+    // номер в справочнике: присваивается при добавлении, номера идут подряд с 0
+    uint32_t id = 0;
     std::vector<Stop*> route;
     bool is_roundtrip;
+    // собственная скорость в км/ч; 0 - скорость из настроек маршрутизации
+    double velocity = 0;
+    // отправления рейсов с первой остановки развернутого маршрута в минутах от начала
+    // суток, по возрастанию. Без расписания автобус ждут bus_wait_time
+    std::vector<double> departures;
 };
 
 struct Stop {
@@ -61,6 +92,8 @@ struct Stop {
         return name.empty();
     }
     std::string name;
+    // номер в справочнике: присваивается при добавлении, номера идут подряд с 0
+    uint32_t id = 0;
     geo::Coordinates coordinates;
     std::unordered_set<Bus*> buses;
 };
@@ -77,4 +110,27 @@ struct BusStat {
     double curvature = 0; 
 };
 
+// элемент маршрута: ожидание на остановке name или поездка на автобусе name через span_count остановок
+enum class RouteItemType {
+    WAIT,
+    BUS,
+    WALK,
+};
+
+struct RouteItem {
+    RouteItemType type = RouteItemType::WAIT;
+    // остановка ожидания, автобус или остановка, к которой (от которой) идет пешеход;
+    // у пути пешком от точки до точки имени нет
+    std::string_view name;
+    int span_count = 0;
+    double time = 0;
+    // пройденное пешком расстояние в метрах
+    double distance = 0;
+};
+
+struct RouteStat {
+    double total_time = 0;
+    std::vector<RouteItem> items;
+};
+
 }
\ No newline at end of file
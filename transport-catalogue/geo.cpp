@@ -1,6 +1,7 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace geo {
@@ -17,4 +18,34 @@ double ComputeDistance(Coordinates from, Coordinates to) {
         * RADIUS_OF_EARTH;
 }
 
+bool Rect::IntersectsSegment(Coordinates from, Coordinates to) const {
+    // отсечение Лианга-Барски: точки отрезка from + t * (to - from), t из [0, 1],
+    // последовательно ограничиваются каждой из четырех сторон области
+    double t_begin = 0;
+    double t_end = 1;
+    const auto clip = [&t_begin, &t_end](double p, double q) {
+        if (p == 0) {
+            // отрезок параллелен стороне: лежит либо целиком внутри полосы, либо вне ее
+            return q >= 0;
+        }
+        const double t = q / p;
+        if (p < 0) {
+            if (t > t_end) {
+                return false;
+            }
+            t_begin = std::max(t_begin, t);
+        } else {
+            if (t < t_begin) {
+                return false;
+            }
+            t_end = std::min(t_end, t);
+        }
+        return true;
+    };
+    const double d_lng = to.lng - from.lng;
+    const double d_lat = to.lat - from.lat;
+    return clip(-d_lng, from.lng - min_lng) && clip(d_lng, max_lng - from.lng)
+        && clip(-d_lat, from.lat - min_lat) && clip(d_lat, max_lat - from.lat);
+}
+
 }  // namespace geo
\ No newline at end of file
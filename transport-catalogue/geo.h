@@ -17,4 +17,19 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Прямоугольная область: широта в [min_lat, max_lat], долгота в [min_lng, max_lng]
+struct Rect {
+    double min_lat = 0;
+    double min_lng = 0;
+    double max_lat = 0;
+    double max_lng = 0;
+
+    bool Contains(Coordinates point) const {
+        return min_lat <= point.lat && point.lat <= max_lat
+            && min_lng <= point.lng && point.lng <= max_lng;
+    }
+    // пересекает ли область отрезок между точками (широта и долгота - как плоские координаты)
+    bool IntersectsSegment(Coordinates from, Coordinates to) const;
+};
+
 } // geo
\ No newline at end of file
@@ -1,25 +1,38 @@
 #pragma once
 
+#include "binary_io.h"
 #include "ranges.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
-#include <string>
 
 namespace graph {
 
 using VertexId = size_t;
 using EdgeId = size_t;
 
-// from, to, weight, span, type, name (bus or stop if wait)
+// WAIT - ожидание на остановке, BUS - поездка сразу через span остановок,
+// BOARD, RIDE, ALIGHT - посадка, перегон до следующей остановки и выход
+enum class EdgeType : uint8_t {
+    WAIT,
+    BUS,
+    BOARD,
+    RIDE,
+    ALIGHT,
+};
+
+// from, to, weight, span, name_id (id автобуса или остановки, если ожидание), type.
+// Имена по name_id хранит владелец графа, чтобы не копировать строку в каждое ребро
 template <typename Weight>
 struct Edge {
     VertexId from;
     VertexId to;
     Weight weight;
-    bool is_wait;
-    int span;
-    std::string name;
+    uint32_t span;
+    uint32_t name_id;
+    EdgeType type;
 };
 
 template <typename Weight>
@@ -33,14 +46,35 @@ public:
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Переводит списки смежности в компактный формат CSR: исходящие ребра каждой вершины
+    // лежат подряд, а их номера, концы и веса - в отдельных массивах.
+    // После заморозки добавлять ребра нельзя
+    void Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    // Вызывает callback(edge_id, to, weight) для каждого исходящего из вершины ребра
+    template <typename Callback>
+    void ForEachIncidentEdge(VertexId vertex, Callback callback) const;
+
+    // Сохраняет число вершин и ребра в двоичном виде; загруженный граф сразу заморожен.
+    // Сохраненное число вершин должно совпасть с vertex_count, иначе ReadError
+    void Save(std::ostream& output) const;
+    static DirectedWeightedGraph Load(std::istream& input, size_t vertex_count);
+
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    bool is_frozen_ = false;
+    std::vector<size_t> offsets_;
+    std::vector<EdgeId> incident_edge_ids_;
+    std::vector<VertexId> incident_targets_;
+    std::vector<Weight> incident_weights_;
 };
 
 template <typename Weight>
@@ -50,15 +84,50 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (is_frozen_) {
+        throw std::logic_error("Can't add an edge to the frozen graph");
+    }
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (is_frozen_) {
+        return;
+    }
+    const size_t vertex_count = incidence_lists_.size();
+    offsets_.assign(vertex_count + 1, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets_[vertex + 1] = offsets_[vertex] + incidence_lists_[vertex].size();
+    }
+
+    incident_edge_ids_.reserve(edges_.size());
+    incident_targets_.reserve(edges_.size());
+    incident_weights_.reserve(edges_.size());
+    // порядок ребер внутри вершины сохраняется, поэтому пути не зависят от заморозки
+    for (const IncidenceList& incidence_list : incidence_lists_) {
+        for (const EdgeId edge_id : incidence_list) {
+            incident_edge_ids_.push_back(edge_id);
+            incident_targets_.push_back(edges_[edge_id].to);
+            incident_weights_.push_back(edges_[edge_id].weight);
+        }
+    }
+
+    std::vector<IncidenceList>{}.swap(incidence_lists_);
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return is_frozen_ ? offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
@@ -74,7 +143,51 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    if (is_frozen_) {
+        return ranges::Range{incident_edge_ids_.begin() + offsets_.at(vertex),
+                             incident_edge_ids_.begin() + offsets_.at(vertex + 1)};
+    }
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
 
+template <typename Weight>
+template <typename Callback>
+void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex, Callback callback) const {
+    if (is_frozen_) {
+        const size_t end = offsets_.at(vertex + 1);
+        for (size_t i = offsets_[vertex]; i < end; ++i) {
+            callback(incident_edge_ids_[i], incident_targets_[i], incident_weights_[i]);
+        }
+        return;
+    }
+    for (const EdgeId edge_id : incidence_lists_.at(vertex)) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        callback(edge_id, edge.to, edge.weight);
+    }
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Save(std::ostream& output) const {
+    binary_io::Write<uint64_t>(output, GetVertexCount());
+    binary_io::WriteVector(output, edges_);
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight> DirectedWeightedGraph<Weight>::Load(std::istream& input, size_t vertex_count) {
+    if (binary_io::Read<uint64_t>(input) != vertex_count) {
+        throw binary_io::ReadError("graph doesn't match the catalogue");
+    }
+    DirectedWeightedGraph graph(vertex_count);
+    graph.edges_ = binary_io::ReadVector<Edge<Weight>>(input);
+    for (EdgeId id = 0; id < graph.edges_.size(); ++id) {
+        const Edge<Weight>& edge = graph.edges_[id];
+        if (edge.from >= graph.incidence_lists_.size() || edge.to >= graph.incidence_lists_.size()) {
+            throw binary_io::ReadError("graph edge refers to a missing vertex");
+        }
+        graph.incidence_lists_[edge.from].push_back(id);
+    }
+    graph.Freeze();
+    return graph;
+}
+
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "json_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace json::arena {
+
+using namespace std::literals;
+
+void* Arena::AllocateBytes(size_t size, size_t alignment) {
+    size_t offset = (used_ + alignment - 1) / alignment * alignment;
+    if (blocks_.empty() || offset + size > capacity_) {
+        // большие массивы получают собственный блок
+        const size_t capacity = std::max(BLOCK_SIZE, size + alignment);
+        blocks_.push_back(std::make_unique<std::byte[]>(capacity));
+        capacity_ = capacity;
+        used_ = 0;
+        offset = 0;
+    }
+    used_ = offset + size;
+    return blocks_.back().get() + offset;
+}
+
+void Arena::Clear() {
+    if (blocks_.size() > 1 || capacity_ != BLOCK_SIZE) {
+        blocks_.clear();
+        capacity_ = 0;
+    }
+    used_ = 0;
+}
+
+const Node& Array::at(size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("Array index is out of range"s);
+    }
+    return items_[index];
+}
+
+const Member* Dict::find(std::string_view key) const {
+    const Member* it = std::lower_bound(begin(), end(), key, [](const Member& member, std::string_view value) {
+        return member.first < value;
+    });
+    return it != end() && it->first == key ? it : end();
+}
+
+const Node& Dict::at(std::string_view key) const {
+    const Member* it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("No key '"s + std::string(key) + "' in dict"s);
+    }
+    return it->second;
+}
+
+std::string_view Document::Keep(const Parser& parser, std::string_view str) {
+    if (parser.IsInBuffer(str)) {
+        return str;
+    }
+    char* const data = arena_.Allocate<char>(str.size());
+    std::memcpy(data, str.data(), str.size());
+    return {data, str.size()};
+}
+
+Node Document::Build(Parser& parser) {
+    switch (parser.PeekType()) {
+        case Parser::ValueType::ARRAY: {
+            // вложенные значения временно лежат в общем стеке, а готовый массив копируется в арену
+            const size_t first = items_.size();
+            parser.StartArray();
+            while (parser.NextItem()) {
+                Node item = Build(parser);
+                items_.push_back(item);
+            }
+            const size_t size = items_.size() - first;
+            Node* const items = arena_.Allocate<Node>(size);
+            std::uninitialized_copy(items_.begin() + first, items_.end(), items);
+            items_.resize(first);
+            return Array{items, size};
+        }
+        case Parser::ValueType::DICT: {
+            const size_t first = members_.size();
+            parser.StartDict();
+            while (const auto key = parser.NextKey()) {
+                const std::string_view kept_key = Keep(parser, *key);
+                Node value = Build(parser);
+                members_.emplace_back(kept_key, value);
+            }
+            const auto begin = members_.begin() + first;
+            std::stable_sort(begin, members_.end(), [](const Member& lhs, const Member& rhs) {
+                return lhs.first < rhs.first;
+            });
+            const auto duplicate = std::adjacent_find(begin, members_.end(), [](const Member& lhs, const Member& rhs) {
+                return lhs.first == rhs.first;
+            });
+            if (duplicate != members_.end()) {
+                throw ParsingError("Duplicate key '"s + std::string(duplicate->first) + "' have been found");
+            }
+            const size_t size = members_.size() - first;
+            Member* const members = arena_.Allocate<Member>(size);
+            std::uninitialized_copy(begin, members_.end(), members);
+            members_.resize(first);
+            return Dict{members, size};
+        }
+        case Parser::ValueType::STRING:
+            return Keep(parser, parser.ReadString());
+        case Parser::ValueType::BOOL:
+            return parser.ReadBool();
+        case Parser::ValueType::NUL:
+            parser.ReadNull();
+            return nullptr;
+        case Parser::ValueType::NUMBER:
+            return std::visit([](auto value) {
+                return Node(value);
+            }, parser.ReadNumber());
+    }
+    throw std::logic_error("Unknown value type"s);
+}
+
+const Node& Document::Read(Parser& parser) {
+    arena_.Clear();
+    items_.clear();
+    members_.clear();
+    root_ = Node{};
+    root_ = Build(parser);
+    return root_;
+}
+
+Document Load(std::string_view text) {
+    Parser parser(text);
+    Document document;
+    document.Read(parser);
+    return document;
+}
+
+}  // namespace json::arena
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "json_parser.h"
+
+// Дерево JSON в памяти одного документа: узлы, массивы и словари размещаются в арене
+// несколькими крупными блоками, словари - отсортированные по ключу массивы пар,
+// а ключи и строки ссылаются на разбираемый буфер (экранированные копируются в арену).
+// Поэтому буфер должен жить дольше документа. Интерфейс чтения - как у json::Node
+namespace json::arena {
+
+// Выделяет память подряд из крупных блоков; освобождается только вся сразу
+class Arena {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    Arena() = default;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    template <typename T>
+    T* Allocate(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena never calls destructors");
+        return static_cast<T*>(AllocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    // освобождает все выделенное, оставляя первый блок для повторного использования
+    void Clear();
+
+private:
+    void* AllocateBytes(size_t size, size_t alignment);
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    size_t used_ = 0;
+    size_t capacity_ = 0;
+};
+
+class Node;
+using Member = std::pair<std::string_view, Node>;
+
+class Array {
+public:
+    Array() = default;
+    Array(const Node* items, size_t size)
+        : items_(items), size_(size) {
+    }
+
+    const Node* begin() const {
+        return items_;
+    }
+    const Node* end() const;
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    const Node& operator[](size_t index) const;
+    const Node& at(size_t index) const;
+
+private:
+    const Node* items_ = nullptr;
+    size_t size_ = 0;
+};
+
+class Dict {
+public:
+    Dict() = default;
+    Dict(const Member* members, size_t size)
+        : members_(members), size_(size) {
+    }
+
+    // пары упорядочены по ключу, как в std::map
+    const Member* begin() const {
+        return members_;
+    }
+    const Member* end() const;
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    const Member* find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    const Node& at(std::string_view key) const;
+
+private:
+    const Member* members_ = nullptr;
+    size_t size_ = 0;
+};
+
+class Node final
+    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string_view> {
+public:
+    using variant::variant;
+    using Value = variant;
+
+    bool IsInt() const {
+        return std::holds_alternative<int>(*this);
+    }
+    int AsInt() const {
+        using namespace std::literals;
+        if (!IsInt()) {
+            throw std::logic_error("Not an int"s);
+        }
+        return std::get<int>(*this);
+    }
+
+    bool IsPureDouble() const {
+        return std::holds_alternative<double>(*this);
+    }
+    bool IsDouble() const {
+        return IsInt() || IsPureDouble();
+    }
+    double AsDouble() const {
+        using namespace std::literals;
+        if (!IsDouble()) {
+            throw std::logic_error("Not a double"s);
+        }
+        return IsPureDouble() ? std::get<double>(*this) : AsInt();
+    }
+
+    bool IsBool() const {
+        return std::holds_alternative<bool>(*this);
+    }
+    bool AsBool() const {
+        using namespace std::literals;
+        if (!IsBool()) {
+            throw std::logic_error("Not a bool"s);
+        }
+        return std::get<bool>(*this);
+    }
+
+    bool IsNull() const {
+        return std::holds_alternative<std::nullptr_t>(*this);
+    }
+
+    bool IsArray() const {
+        return std::holds_alternative<Array>(*this);
+    }
+    const Array& AsArray() const {
+        using namespace std::literals;
+        if (!IsArray()) {
+            throw std::logic_error("Not an array"s);
+        }
+        return std::get<Array>(*this);
+    }
+
+    bool IsString() const {
+        return std::holds_alternative<std::string_view>(*this);
+    }
+    std::string_view AsString() const {
+        using namespace std::literals;
+        if (!IsString()) {
+            throw std::logic_error("Not a string"s);
+        }
+        return std::get<std::string_view>(*this);
+    }
+
+    bool IsDict() const {
+        return std::holds_alternative<Dict>(*this);
+    }
+    const Dict& AsDict() const {
+        using namespace std::literals;
+        if (!IsDict()) {
+            throw std::logic_error("Not a dict"s);
+        }
+        return std::get<Dict>(*this);
+    }
+
+    const Value& GetValue() const {
+        return *this;
+    }
+};
+
+// Массивы и словари хранят указатели на узлы, поэтому часть их методов определена после Node
+inline const Node* Array::end() const {
+    return items_ + size_;
+}
+
+inline const Node& Array::operator[](size_t index) const {
+    return items_[index];
+}
+
+inline const Member* Dict::end() const {
+    return members_ + size_;
+}
+
+inline size_t Dict::count(std::string_view key) const {
+    return find(key) == end() ? 0 : 1;
+}
+
+class Document {
+public:
+    Document() = default;
+
+    // Читает очередное значение разборщика; прежнее содержимое документа освобождается
+    const Node& Read(Parser& parser);
+
+    const Node& GetRoot() const {
+        return root_;
+    }
+
+private:
+    Node Build(Parser& parser);
+    // строка из внутреннего буфера разборщика перезапишется следующим чтением - копируем
+    std::string_view Keep(const Parser& parser, std::string_view str);
+
+    Arena arena_;
+    Node root_;
+    // элементы и пары незаконченных массивов и словарей всех уровней вложенности
+    std::vector<Node> items_;
+    std::vector<Member> members_;
+};
+
+Document Load(std::string_view text);
+
+}  // namespace json::arena
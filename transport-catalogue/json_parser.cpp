@@ -0,0 +1,353 @@
+#include "json_parser.h"
+
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <system_error>
+
+namespace json {
+
+using namespace std::literals;
+
+std::string ReadText(std::istream& input) {
+    std::string text;
+    char buffer[1 << 16];
+    while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+        text.append(buffer, static_cast<size_t>(input.gcount()));
+    }
+    return text;
+}
+
+Parser::Parser(std::string_view buffer)
+    : buffer_(buffer) {
+}
+
+void Parser::SkipSpaces() {
+    while (pos_ < buffer_.size()) {
+        const char c = buffer_[pos_];
+        if (c != ' ' && c != '\n' && c != '\t' && c != '\r') {
+            break;
+        }
+        ++pos_;
+    }
+}
+
+char Parser::PeekChar() {
+    SkipSpaces();
+    if (pos_ == buffer_.size()) {
+        throw ParsingError("Unexpected EOF"s);
+    }
+    return buffer_[pos_];
+}
+
+void Parser::Expect(char c) {
+    const char actual = PeekChar();
+    if (actual != c) {
+        throw ParsingError("'"s + c + "' is expected but '"s + actual + "' has been found"s);
+    }
+    ++pos_;
+}
+
+Parser::ValueType Parser::PeekType() {
+    switch (PeekChar()) {
+        case '[':
+            return ValueType::ARRAY;
+        case '{':
+            return ValueType::DICT;
+        case '"':
+            return ValueType::STRING;
+        case 't':
+            [[fallthrough]];
+        case 'f':
+            return ValueType::BOOL;
+        case 'n':
+            return ValueType::NUL;
+        default:
+            return ValueType::NUMBER;
+    }
+}
+
+void Parser::StartArray() {
+    Expect('[');
+    has_items_.push_back(false);
+}
+
+bool Parser::NextItem() {
+    if (has_items_.empty()) {
+        throw std::logic_error("No open array"s);
+    }
+    if (PeekChar() == ']') {
+        ++pos_;
+        has_items_.pop_back();
+        return false;
+    }
+    if (has_items_.back()) {
+        Expect(',');
+    }
+    has_items_.back() = true;
+    return true;
+}
+
+void Parser::StartDict() {
+    Expect('{');
+    has_items_.push_back(false);
+}
+
+std::optional<std::string_view> Parser::NextKey() {
+    if (has_items_.empty()) {
+        throw std::logic_error("No open dict"s);
+    }
+    if (PeekChar() == '}') {
+        ++pos_;
+        has_items_.pop_back();
+        return std::nullopt;
+    }
+    if (has_items_.back()) {
+        Expect(',');
+    }
+    has_items_.back() = true;
+    const std::string_view key = ParseString();
+    Expect(':');
+    return key;
+}
+
+std::string_view Parser::ParseString() {
+    Expect('"');
+    const size_t begin = pos_;
+    // без экранирования строка - это просто участок буфера
+    while (pos_ < buffer_.size()) {
+        const char c = buffer_[pos_];
+        if (c == '"') {
+            return buffer_.substr(begin, pos_++ - begin);
+        }
+        if (c == '\\') {
+            break;
+        }
+        if (c == '\n' || c == '\r') {
+            throw ParsingError("Unexpected end of line"s);
+        }
+        ++pos_;
+    }
+
+    unescaped_.assign(buffer_.data() + begin, pos_ - begin);
+    while (pos_ < buffer_.size()) {
+        const char c = buffer_[pos_++];
+        if (c == '"') {
+            return unescaped_;
+        }
+        if (c == '\n' || c == '\r') {
+            throw ParsingError("Unexpected end of line"s);
+        }
+        if (c != '\\') {
+            unescaped_.push_back(c);
+            continue;
+        }
+        if (pos_ == buffer_.size()) {
+            break;
+        }
+        const char escaped_char = buffer_[pos_++];
+        switch (escaped_char) {
+            case 'n':
+                unescaped_.push_back('\n');
+                break;
+            case 't':
+                unescaped_.push_back('\t');
+                break;
+            case 'r':
+                unescaped_.push_back('\r');
+                break;
+            case '"':
+                unescaped_.push_back('"');
+                break;
+            case '\\':
+                unescaped_.push_back('\\');
+                break;
+            default:
+                throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+        }
+    }
+    throw ParsingError("String parsing error"s);
+}
+
+std::string_view Parser::ReadString() {
+    if (PeekType() != ValueType::STRING) {
+        throw std::logic_error("Not a string"s);
+    }
+    return ParseString();
+}
+
+std::string_view Parser::ReadLiteral() {
+    SkipSpaces();
+    const size_t begin = pos_;
+    while (pos_ < buffer_.size() && std::isalpha(static_cast<unsigned char>(buffer_[pos_]))) {
+        ++pos_;
+    }
+    return buffer_.substr(begin, pos_ - begin);
+}
+
+std::variant<int, double> Parser::ReadNumber() {
+    SkipSpaces();
+    const size_t begin = pos_;
+    const auto is_digit = [this] {
+        return pos_ < buffer_.size() && std::isdigit(static_cast<unsigned char>(buffer_[pos_]));
+    };
+    const auto read_digits = [this, &is_digit] {
+        if (!is_digit()) {
+            throw ParsingError("A digit is expected"s);
+        }
+        while (is_digit()) {
+            ++pos_;
+        }
+    };
+    const auto skip_char = [this](char c) {
+        if (pos_ < buffer_.size() && buffer_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    };
+
+    skip_char('-');
+    // после 0 в JSON не могут идти другие цифры
+    if (!skip_char('0')) {
+        read_digits();
+    }
+    bool is_int = true;
+    if (skip_char('.')) {
+        read_digits();
+        is_int = false;
+    }
+    if (skip_char('e') || skip_char('E')) {
+        if (!skip_char('+')) {
+            skip_char('-');
+        }
+        read_digits();
+        is_int = false;
+    }
+
+    const char* const first = buffer_.data() + begin;
+    const char* const last = buffer_.data() + pos_;
+    if (is_int) {
+        int value = 0;
+        // при переполнении int число читается как double
+        if (const auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc{} && ptr == last) {
+            return value;
+        }
+    }
+    double value = 0;
+    if (const auto [ptr, ec] = std::from_chars(first, last, value); ec != std::errc{} || ptr != last) {
+        throw ParsingError("Failed to convert "s + std::string(first, last) + " to number"s);
+    }
+    return value;
+}
+
+int Parser::ReadInt() {
+    const auto number = ReadNumber();
+    if (!std::holds_alternative<int>(number)) {
+        throw std::logic_error("Not an int"s);
+    }
+    return std::get<int>(number);
+}
+
+double Parser::ReadDouble() {
+    const auto number = ReadNumber();
+    return std::holds_alternative<int>(number) ? std::get<int>(number) : std::get<double>(number);
+}
+
+bool Parser::ReadBool() {
+    const std::string_view literal = ReadLiteral();
+    if (literal == "true"sv) {
+        return true;
+    } else if (literal == "false"sv) {
+        return false;
+    }
+    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as bool"s);
+}
+
+void Parser::ReadNull() {
+    if (const std::string_view literal = ReadLiteral(); literal != "null"sv) {
+        throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+    }
+}
+
+Node Parser::ReadNode() {
+    switch (PeekType()) {
+        case ValueType::ARRAY: {
+            Array array;
+            StartArray();
+            while (NextItem()) {
+                array.push_back(ReadNode());
+            }
+            return Node(std::move(array));
+        }
+        case ValueType::DICT: {
+            Dict dict;
+            StartDict();
+            while (const auto key = NextKey()) {
+                std::string key_str(*key);
+                if (dict.find(key_str) != dict.end()) {
+                    throw ParsingError("Duplicate key '"s + key_str + "' have been found");
+                }
+                dict.emplace(std::move(key_str), ReadNode());
+            }
+            return Node(std::move(dict));
+        }
+        case ValueType::STRING:
+            return Node(std::string(ParseString()));
+        case ValueType::BOOL:
+            return Node(ReadBool());
+        case ValueType::NUL:
+            ReadNull();
+            return Node(nullptr);
+        case ValueType::NUMBER:
+            return std::visit([](auto value) {
+                return Node(value);
+            }, ReadNumber());
+    }
+    throw std::logic_error("Unknown value type"s);
+}
+
+std::string_view Parser::SkipValue() {
+    const ValueType type = PeekType();
+    const size_t begin = pos_;
+    switch (type) {
+        case ValueType::ARRAY:
+            [[fallthrough]];
+        case ValueType::DICT: {
+            // структура вложенных значений не проверяется: она проверится при их разборе
+            size_t depth = 0;
+            do {
+                if (pos_ == buffer_.size()) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                const char c = buffer_[pos_];
+                if (c == '"') {
+                    ParseString();
+                    continue;
+                }
+                if (c == '[' || c == '{') {
+                    ++depth;
+                } else if (c == ']' || c == '}') {
+                    --depth;
+                }
+                ++pos_;
+            } while (depth > 0);
+            break;
+        }
+        case ValueType::STRING:
+            ParseString();
+            break;
+        case ValueType::BOOL:
+            ReadBool();
+            break;
+        case ValueType::NUL:
+            ReadNull();
+            break;
+        case ValueType::NUMBER:
+            ReadNumber();
+            break;
+    }
+    return buffer_.substr(begin, pos_ - begin);
+}
+
+}  // namespace json
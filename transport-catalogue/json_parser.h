@@ -0,0 +1,77 @@
+#pragma once
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "json.h"
+
+namespace json {
+
+// Читает весь поток в строку, чтобы разбирать его из непрерывного буфера
+std::string ReadText(std::istream& input);
+
+// Потоковый (pull) разбор JSON из непрерывного буфера без построения дерева: значения
+// читаются по порядку, вложенные массивы и словари обходятся через StartArray/NextItem
+// и StartDict/NextKey. Буфер не копируется и должен жить дольше разборщика.
+// Строки без экранирования возвращаются ссылками на буфер, остальные - на внутренний
+// буфер разборщика, поэтому прочитанная строка действительна до следующего чтения
+class Parser {
+public:
+    enum class ValueType {
+        NUL,
+        BOOL,
+        NUMBER,
+        STRING,
+        ARRAY,
+        DICT,
+    };
+
+    explicit Parser(std::string_view buffer);
+
+    ValueType PeekType();
+
+    // Массив: StartArray(), затем, пока NextItem() возвращает true, - чтение очередного элемента
+    void StartArray();
+    bool NextItem();
+
+    // Словарь: StartDict(), затем, пока NextKey() возвращает ключ, - чтение значения по нему
+    void StartDict();
+    std::optional<std::string_view> NextKey();
+
+    std::string_view ReadString();
+    // целое, если число записано без дробной части и помещается в int, иначе double
+    std::variant<int, double> ReadNumber();
+    int ReadInt();
+    double ReadDouble();
+    bool ReadBool();
+    void ReadNull();
+
+    // очередное значение целиком в виде дерева
+    Node ReadNode();
+    // пропускает очередное значение и возвращает его исходный текст
+    std::string_view SkipValue();
+
+    // ссылается ли прочитанная строка на сам буфер (а не на внутренний буфер разборщика)
+    bool IsInBuffer(std::string_view str) const {
+        return str.data() >= buffer_.data() && str.data() + str.size() <= buffer_.data() + buffer_.size();
+    }
+
+private:
+    void SkipSpaces();
+    char PeekChar();
+    void Expect(char c);
+    std::string_view ReadLiteral();
+    std::string_view ParseString();
+
+    std::string_view buffer_;
+    size_t pos_ = 0;
+    std::string unescaped_;
+    // для каждого открытого массива или словаря: прочитан ли в нем хотя бы один элемент
+    std::vector<bool> has_items_;
+};
+
+}  // namespace json
@@ -13,45 +13,91 @@ FillRequests::FillRequests(t_c::TransportCatalogue& db)
 }
 
 StatRequests::StatRequests(
-                            const t_c::TransportCatalogue& db,
-                            const renderer::MapRenderer& renderer,
+                            const t_c::CatalogueReader& db,
+                            const renderer::RenderSettings& render_settings,
                             const TransportRouter& router
-    ) : RequestHandler(db, renderer, router), builder_() {
+    ) : RequestHandler(db, render_settings, router) {
 }
 
-void FillRequests::LoadBusRequest(const Dict& req) {
-    const std::string name = req.at("name"s).AsString();
+void FillRequests::AddBusRequest(std::string name, const std::vector<std::string>& stops, bool is_round,
+                                 const BusSchedule& schedule) {
+    std::deque<std::string> stops_deq(stops.begin(), stops.end());
+    if (!is_round) {
+        stops_deq.insert(stops_deq.end()
+                , std::next(stops_deq.rbegin()), stops_deq.rend());
+    }
+
+    BusData bus{std::move(name), std::move(stops_deq), is_round};
+    if (schedule.velocity) {
+        if (!(*schedule.velocity > 0)) {
+            throw std::invalid_argument("wrong bus velocity"s);
+        }
+        bus.velocity = *schedule.velocity;
+    }
+    if (schedule.departures && schedule.headway) {
+        throw std::invalid_argument("bus has both departures and headway"s);
+    }
+    if (schedule.departures) {
+        bus.departures = *schedule.departures;
+        std::sort(bus.departures.begin(), bus.departures.end());
+    } else if (schedule.headway) {
+        // по умолчанию автобус ходит с интервалом весь день
+        const double headway = *schedule.headway;
+        const double first = schedule.first_departure.value_or(0);
+        const double last = schedule.last_departure.value_or(MINUTES_IN_DAY);
+        if (!(headway > 0) || first > last) {
+            throw std::invalid_argument("wrong bus headway"s);
+        }
+        for (size_t i = 0; first + i * headway <= last; ++i) {
+            bus.departures.push_back(first + i * headway);
+        }
+    }
+    bus_requests_.push_back(std::move(bus));
+}
+
+void FillRequests::LoadBusRequest(const InputDict& req) {
+    const std::string name(req.at("name"s).AsString());
     const bool is_round = req.at("is_roundtrip"s).AsBool();
 
-    const Array& stops_node = req.at("stops"s).AsArray();
+    const InputArray& stops_node = req.at("stops"s).AsArray();
     std::vector<std::string> stops_arr;
     stops_arr.reserve(stops_node.size()); 
-    for (const Node& nd : stops_node) {
+    for (const InputNode& nd : stops_node) {
         stops_arr.emplace_back(nd.AsString());
     }
-    std::deque<std::string> stops_deq(stops_arr.begin(), stops_arr.end());
-    if (!is_round) {
-        stops_deq.insert(stops_deq.end()
-                , std::next(stops_deq.rbegin()), stops_deq.rend());
-    }
 
-    bus_requests_.push_back(BusData{name, stops_deq, is_round});
+    BusSchedule schedule;
+    const auto find_double = [&req](const char* key) -> std::optional<double> {
+        const auto it = req.find(key);
+        return it != req.end() ? std::optional<double>(it->second.AsDouble()) : std::nullopt;
+    };
+    schedule.velocity = find_double("velocity");
+    schedule.headway = find_double("headway");
+    schedule.first_departure = find_double("first_departure");
+    schedule.last_departure = find_double("last_departure");
+    if (const auto it = req.find("departures"s); it != req.end()) {
+        schedule.departures.emplace();
+        for (const InputNode& nd : it->second.AsArray()) {
+            schedule.departures->push_back(nd.AsDouble());
+        }
+    }
+    AddBusRequest(name, stops_arr, is_round, schedule);
 }
  
-void FillRequests::LoadStopRequest(const Dict& req) {
+void FillRequests::LoadStopRequest(const InputDict& req) {
 
-    const std::string name = req.at("name"s).AsString();
+    const std::string name(req.at("name"s).AsString());
     const double latitude = req.at("latitude"s).AsDouble();
     const double longitude = req.at("longitude"s).AsDouble();
 
     StopData stop{name, latitude, longitude};
 
-    const Dict dists_dict = req.at("road_distances"s).AsDict();
+    const InputDict& dists_dict = req.at("road_distances"s).AsDict();
     for (const auto& [stop_name, dist] : dists_dict) {
-        stop.road_distances.insert({stop_name, dist.AsDouble()});
+        stop.road_distances.insert({std::string(stop_name), dist.AsDouble()});
     }
 
-    stop_requests_.push_back(stop);
+    stop_requests_.push_back(std::move(stop));
 }
 
 void FillRequests::ApplyDistances(Stop& from_stop , RoadDistances& road_distances) {
@@ -61,11 +107,11 @@ void FillRequests::ApplyDistances(Stop& from_stop , RoadDistances& road_distance
     }
 }
 
-void FillRequests::ProcessBaseRequests(const Array& arr_reqs) {
+void FillRequests::ProcessBaseRequests(const InputArray& arr_reqs) {
 
-    for (const Node& node_map : arr_reqs) {
+    for (const InputNode& node_map : arr_reqs) {
 
-        const std::string type = node_map.AsDict().at("type"s).AsString();
+        const std::string_view type = node_map.AsDict().at("type"s).AsString();
         if (type == "Bus"s) {
             LoadBusRequest(node_map.AsDict());
         } else if (type == "Stop"s) {
@@ -74,11 +120,99 @@ void FillRequests::ProcessBaseRequests(const Array& arr_reqs) {
             throw std::invalid_argument("wrong request type"s);
         }
     }
+    ApplyRequests();
+}
+
+void FillRequests::ProcessBaseRequests(json::Parser& parser) {
+    parser.StartArray();
+    while (parser.NextItem()) {
+        LoadRequest(parser);
+    }
+    ApplyRequests();
+}
+
+// Поля запроса могут идти в любом порядке, поэтому сначала читаются все, затем проверяется тип
+void FillRequests::LoadRequest(json::Parser& parser) {
+    std::string type;
+    std::optional<std::string> name;
+    std::optional<double> latitude;
+    std::optional<double> longitude;
+    std::unordered_map<std::string, double> road_distances;
+    std::optional<std::vector<std::string>> stops;
+    std::optional<bool> is_round;
+    BusSchedule schedule;
+
+    parser.StartDict();
+    while (const auto key = parser.NextKey()) {
+        if (*key == "type"sv) {
+            type = parser.ReadString();
+        } else if (*key == "name"sv) {
+            name = std::string(parser.ReadString());
+        } else if (*key == "latitude"sv) {
+            latitude = parser.ReadDouble();
+        } else if (*key == "longitude"sv) {
+            longitude = parser.ReadDouble();
+        } else if (*key == "road_distances"sv) {
+            parser.StartDict();
+            while (const auto stop_name = parser.NextKey()) {
+                std::string stop_name_str(*stop_name);
+                road_distances.insert({std::move(stop_name_str), parser.ReadDouble()});
+            }
+        } else if (*key == "stops"sv) {
+            stops.emplace();
+            parser.StartArray();
+            while (parser.NextItem()) {
+                stops->emplace_back(parser.ReadString());
+            }
+        } else if (*key == "is_roundtrip"sv) {
+            is_round = parser.ReadBool();
+        } else if (*key == "velocity"sv) {
+            schedule.velocity = parser.ReadDouble();
+        } else if (*key == "departures"sv) {
+            schedule.departures.emplace();
+            parser.StartArray();
+            while (parser.NextItem()) {
+                schedule.departures->push_back(parser.ReadDouble());
+            }
+        } else if (*key == "headway"sv) {
+            schedule.headway = parser.ReadDouble();
+        } else if (*key == "first_departure"sv) {
+            schedule.first_departure = parser.ReadDouble();
+        } else if (*key == "last_departure"sv) {
+            schedule.last_departure = parser.ReadDouble();
+        } else {
+            parser.SkipValue();
+        }
+    }
+
+    const auto require = [](const auto& field, const char* field_name) -> const auto& {
+        if (!field) {
+            throw std::invalid_argument("base request: no "s + field_name);
+        }
+        return *field;
+    };
+    if (type == "Bus"s) {
+        AddBusRequest(require(name, "name"), require(stops, "stops"), require(is_round, "is_roundtrip"),
+                      schedule);
+    } else if (type == "Stop"s) {
+        StopData stop{require(name, "name"), require(latitude, "latitude"), require(longitude, "longitude")};
+        stop.road_distances = std::move(road_distances);
+        stop_requests_.push_back(std::move(stop));
+    } else {
+        throw std::invalid_argument("wrong request type"s);
+    }
+}
 
+void FillRequests::ApplyRequests() {
     for (const auto& stop_data : stop_requests_) {
         db_.AddStop({stop_data.name, stop_data.coords});
     }
 
+    size_t distances_count = 0;
+    for (const auto& stop_data : stop_requests_) {
+        distances_count += stop_data.road_distances.size();
+    }
+    db_.ReserveDistances(distances_count);
     for (const auto& stop_data : stop_requests_) {
         Stop& stop = db_.FindStop(stop_data.name);
         ApplyDistances(stop, stop_data.road_distances);
@@ -90,15 +224,18 @@ void FillRequests::ProcessBaseRequests(const Array& arr_reqs) {
         for (const auto& stopnm : bus_data.stops) {
             stops_.push_back(&db_.FindStop(stopnm));
         }
-        db_.AddBus(Bus{bus_data.name, stops_, bus_data.is_roundtrip});
+        Bus bus{bus_data.name, stops_, bus_data.is_roundtrip};
+        bus.velocity = bus_data.velocity;
+        bus.departures = bus_data.departures;
+        db_.AddBus(bus);
     }
 }
 
-svg::Color GetColorFromNode(const Node& cnode) {
+svg::Color GetColorFromNode(const InputNode& cnode) {
     if (cnode.IsString()) {
-        return cnode.AsString();
+        return std::string(cnode.AsString());
     } else if (cnode.IsArray()) {
-        Array undercolor_arr = cnode.AsArray();
+        const InputArray& undercolor_arr = cnode.AsArray();
         if (undercolor_arr.size() == 3u) {
             return svg::Rgb(
                             undercolor_arr.at(0).AsInt()
@@ -120,7 +257,7 @@ svg::Color GetColorFromNode(const Node& cnode) {
     }
 }
 
-void FillRequests::ProcessRenderRequests(const Dict& render_settings
+void FillRequests::ProcessRenderRequests(const InputDict& render_settings
                                     , renderer::RenderSettings& settings) {
     settings.width = render_settings.at("width").AsDouble();
     settings.height = render_settings.at("height").AsDouble();
@@ -129,223 +266,483 @@ void FillRequests::ProcessRenderRequests(const Dict& render_settings
     settings.line_width = render_settings.at("line_width").AsDouble();
 
     settings.bus_label_font_size = render_settings.at("bus_label_font_size").AsInt();
-    Array busl_offset = render_settings.at("bus_label_offset").AsArray();
+    const InputArray& busl_offset = render_settings.at("bus_label_offset").AsArray();
     settings.bus_label_offset = svg::Point{
                     busl_offset.at(0).AsDouble()
                     , busl_offset.at(1).AsDouble()
                 };
 
     settings.stop_label_font_size = render_settings.at("stop_label_font_size").AsInt();
-    Array stopl_offset = render_settings.at("stop_label_offset").AsArray();
+    const InputArray& stopl_offset = render_settings.at("stop_label_offset").AsArray();
     settings.stop_label_offset = svg::Point{
                     stopl_offset.at(0).AsDouble()
                     , stopl_offset.at(1).AsDouble()
                 };
 
-    const Node& undercolor_node = render_settings.at("underlayer_color");
+    const InputNode& undercolor_node = render_settings.at("underlayer_color");
     settings.underlayer_color = GetColorFromNode(undercolor_node);
     settings.underlayer_width = render_settings.at("underlayer_width").AsDouble();
 
-    const Array arr_nodes = render_settings.at("color_palette").AsArray();
-    for (const Node& node : arr_nodes) {
+    const InputArray& arr_nodes = render_settings.at("color_palette").AsArray();
+    for (const InputNode& node : arr_nodes) {
         svg::Color color = GetColorFromNode(node);
         settings.color_palette.push_back(color);
     }
 }
 
-void FillRequests::ProcessRoutingSettings(RoutingSettings& settings, const json::Dict& req) {
+void FillRequests::ProcessRoutingSettings(RoutingSettings& settings, const InputDict& req) {
     settings.wait_time = req.at("bus_wait_time"s).AsDouble();
     settings.velocity = req.at("bus_velocity"s).AsDouble();
+
+    // необязательный параметр: по умолчанию пути предподсчитываются для всех пар остановок
+    if (const auto mode_it = req.find("router_mode"s); mode_it != req.end()) {
+        const std::string_view mode = mode_it->second.AsString();
+        if (mode == "all_pairs"s) {
+            settings.router_mode = RouterMode::ALL_PAIRS;
+        } else if (mode == "on_demand"s) {
+            settings.router_mode = RouterMode::ON_DEMAND;
+        } else if (mode == "contraction_hierarchies"s) {
+            settings.router_mode = RouterMode::CONTRACTION_HIERARCHIES;
+        } else if (mode == "raptor"s) {
+            settings.router_mode = RouterMode::RAPTOR;
+        } else {
+            throw std::invalid_argument("wrong router mode"s);
+        }
+    }
+    // необязательные параметры маршрутов между точками
+    if (const auto it = req.find("walk_velocity"s); it != req.end()) {
+        settings.walk_velocity = it->second.AsDouble();
+        if (!(settings.walk_velocity > 0)) {
+            throw std::invalid_argument("wrong walk velocity"s);
+        }
+    }
+    if (const auto it = req.find("walk_stops_count"s); it != req.end()) {
+        settings.walk_stops_count = it->second.AsInt();
+        if (settings.walk_stops_count < 0) {
+            throw std::invalid_argument("wrong walk stops count"s);
+        }
+    }
 }
 
 // stat requests
-void StatRequests::HandleBusRequest(const Dict& req) {
+// Ответ пишется сразу в поток, поэтому ключи идут по алфавиту - в том же порядке,
+// в каком их выводил json::Print для словаря
+void StatRequests::HandleBusRequest(const InputDict& req, json::Writer& writer) {
 
-    builder_.StartDict();
+    writer.StartDict();
     
     const int id = req.at("id").AsInt();
-    builder_.Key("request_id"s).Value(id); 
 
-    const std::string busnm = req.at("name").AsString();
+    const std::string_view busnm = req.at("name").AsString();
     std::optional<BusStat> stat = GetBusStat(busnm);
     if (stat.has_value()) {
-        builder_.Key("curvature"s).Value(stat->curvature)
-        .Key("route_length"s).Value(stat->length)
-        .Key("stop_count"s).Value(stat->stop_count)
-        .Key("unique_stop_count"s).Value(stat->unique_count);
+        writer.Key("curvature"sv).Value(stat->curvature)
+        .Key("request_id"sv).Value(id)
+        .Key("route_length"sv).Value(stat->length)
+        .Key("stop_count"sv).Value(stat->stop_count)
+        .Key("unique_stop_count"sv).Value(stat->unique_count);
     } else {
-        builder_.Key("error_message"s).Value("not found"s);
+        writer.Key("error_message"sv).Value("not found"sv)
+        .Key("request_id"sv).Value(id);
     }
-    builder_.EndDict();
+    writer.EndDict();
 }
 
-std::set<std::string> GetSortedBuses(const std::unordered_set<Bus*> routes) {
-    std::set<std::string> set_buses;
-    for (const auto& bus_ptr : routes) {
-        set_buses.insert(bus_ptr->name);
+void StatRequests::HandleStopRequest(const InputDict& req, json::Writer& writer) {
+
+    writer.StartDict();
+
+    const int id = req.at("id").AsInt();
+
+    const std::string_view stopnm = req.at("name").AsString();
+    const auto buses = GetBusesByStop(stopnm);
+    if (!buses.has_value()) {
+        writer.Key("error_message"sv).Value("not found"sv);
+    } else {
+        writer.Key("buses"sv).StartArray();
+        for (const uint32_t bus_id : *buses) {
+            writer.Value(GetCatalogue().GetBus(bus_id).name);
+        }
+        writer.EndArray();
     }
+    writer.Key("request_id"sv).Value(id);
+
+    writer.EndDict();
+}
+
+geo::Coordinates GetPoint(const InputDict& point) {
+    return {point.at("latitude").AsDouble(), point.at("longitude").AsDouble()};
+}
 
-    return set_buses;
+// область "bbox"; если какой-то границы нет или минимум больше максимума - nullopt,
+// и запрос получает ответ с ошибкой, а не обрывает вывод
+std::optional<geo::Rect> GetRect(const InputDict& bbox) {
+    if (!bbox.count("min_lat") || !bbox.count("min_lng") || !bbox.count("max_lat") || !bbox.count("max_lng")) {
+        return std::nullopt;
+    }
+    const geo::Rect area{
+        bbox.at("min_lat").AsDouble(), bbox.at("min_lng").AsDouble(),
+        bbox.at("max_lat").AsDouble(), bbox.at("max_lng").AsDouble()
+    };
+    if (area.min_lat > area.max_lat || area.min_lng > area.max_lng) {
+        return std::nullopt;
+    }
+    return area;
 }
 
-void StatRequests::HandleStopRequest(const Dict& req) {
+// Без параметров - вся карта; с "bbox" (min_lat, min_lng, max_lat, max_lng) - ее область,
+// с "tile" (z, x, y) - одна из плиток, на которые делится вся карта. Нумерация плиток не
+// Web-Mercator: 2^z x 2^z частей прямоугольника, занятого остановками маршрутов, y - с севера
+// (см. RequestHandler::RenderMapTile)
+void StatRequests::HandleMapRequest(const InputDict& req, json::Writer& writer) {
 
-    builder_.StartDict();
+    writer.StartDict();
 
-    const int id = req.at("id").AsInt();
-    builder_.Key("request_id"s).Value(id);
+    const int id = req.at("id"s).AsInt();
 
-    const std::string stopnm = req.at("name").AsString();
-    std::optional<const std::unordered_set<Bus*>*> routes = GetBusesByStop(stopnm);
-    if (!routes.has_value()) {
-        builder_.Key("error_message"s).Value("not found"s);
-    } else {
-        std::set<std::string> buses = GetSortedBuses(*routes.value());
-        builder_.Key("buses"s).StartArray();
-        for (const auto& bus : buses) {
-            builder_.Value(bus);
+    if (req.count("bbox")) {
+        const std::optional<geo::Rect> area = GetRect(req.at("bbox").AsDict());
+        if (area) {
+            writer.Key("map"sv).Value(RenderMap(*area));
+        } else {
+            writer.Key("error_message"sv).Value("wrong bbox"sv);
         }
-        builder_.EndArray();
+    } else if (req.count("tile")) {
+        const InputDict& tile = req.at("tile").AsDict();
+        const std::string* map = RenderMapTile(tile.at("z").AsInt(), tile.at("x").AsInt(), tile.at("y").AsInt());
+        if (map) {
+            writer.Key("map"sv).Value(*map);
+        } else {
+            writer.Key("error_message"sv).Value("not found"sv);
+        }
+    } else {
+        writer.Key("map"sv).Value(RenderMap());
     }
+    writer.Key("request_id"sv).Value(id);
 
-    builder_.EndDict();
+    writer.EndDict();
 }
 
-void StatRequests::HandleMapRequest(const json::Dict& req) {
+// Ближайшие остановки к точке (latitude, longitude): не больше "count" и не дальше
+// "radius" метров; нужно хотя бы одно из ограничений
+void StatRequests::HandleNearestStopsRequest(const InputDict& req, json::Writer& writer) {
 
-    builder_.StartDict();
+    writer.StartDict();
 
     const int id = req.at("id"s).AsInt();
-    builder_.Key("request_id"s).Value(id);
 
-    std::ostringstream os;
-    RenderMap(os);
-    builder_.Key("map"s).Value(os.str());
+    std::string_view error;
+    size_t count = std::numeric_limits<size_t>::max();
+    if (!req.count("count") && !req.count("radius")) {
+        error = "count or radius is expected"sv;
+    } else if (req.count("count")) {
+        const int value = req.at("count").AsInt();
+        if (value < 0) {
+            error = "wrong count"sv;
+        } else {
+            count = static_cast<size_t>(value);
+        }
+    }
+    if (!error.empty()) {
+        writer.Key("error_message"sv).Value(error);
+        writer.Key("request_id"sv).Value(id);
+        writer.EndDict();
+        return;
+    }
+    const double radius = req.count("radius")
+        ? req.at("radius").AsDouble()
+        : std::numeric_limits<double>::infinity();
+
+    const geo::Coordinates point = GetPoint(req);
+    writer.Key("request_id"sv).Value(id);
+    writer.Key("stops"sv).StartArray();
+    for (const auto& [stop_id, name, distance] : FindNearestStops(point, count, radius)) {
+        writer.StartDict()
+              .Key("distance"sv).Value(distance)
+              .Key("name"sv).Value(name)
+              .EndDict();
+    }
+    writer.EndArray();
 
-    builder_.EndDict();
+    writer.EndDict();
 }
 
-void StatRequests::HandleRouteRequest(const json::Dict& req) {
+// Остановки внутри области "bbox", по имени
+void StatRequests::HandleStopsInAreaRequest(const InputDict& req, json::Writer& writer) {
 
-    builder_.StartDict();
+    writer.StartDict();
 
     const int id = req.at("id"s).AsInt();
-    builder_.Key("request_id"s).Value(id);
 
-    std::string stop_from = req.at("from").AsString();
-    std::string stop_to = req.at("to").AsString();
-    auto route_data = FindRoute(stop_from, stop_to);
+    const std::optional<geo::Rect> area = GetRect(req.at("bbox").AsDict());
+    if (!area) {
+        writer.Key("error_message"sv).Value("wrong bbox"sv);
+        writer.Key("request_id"sv).Value(id);
+        writer.EndDict();
+        return;
+    }
+    writer.Key("request_id"sv).Value(id);
+    writer.Key("stops"sv).StartArray();
+    for (const t_c::StopView& stop : FindStopsInArea(*area)) {
+        writer.Value(stop.name);
+    }
+    writer.EndArray();
 
-    if (!route_data.has_value()) {
-        builder_.Key("error_message").Value("not found");
-    } else {
-        json::Array items;
-        auto route = route_data.value();
-
-        items.reserve(route.edges.size());
-
-        double total_time = 0;
-        for (const auto& edge_id: route.edges) {
-            const graph::Edge<double> edge = GetEdge(edge_id);
-            
-            json::Builder route_item{};
-            route_item.StartDict()
-                                 .Key("time"s).Value(edge.weight);
-            if (edge.is_wait) {
-                route_item
-                          .Key("type"s).Value("Wait"s)
-                          .Key("stop_name"s).Value(edge.name);
-            } else {
-                route_item
-                          .Key("type"s).Value("Bus"s)
-                          .Key("bus"s).Value(edge.name)
-                          .Key("span_count"s).Value(static_cast<int>(edge.span));
-            }
-            route_item.EndDict();
-            items.emplace_back(route_item.Build());
+    writer.EndDict();
+}
 
-            total_time += edge.weight;
+void WriteRouteItems(const RouteStat& route, json::Writer& writer) {
+    writer.Key("items"sv).StartArray();
+    for (const RouteItem& item : route.items) {
+        writer.StartDict();
+        switch (item.type) {
+            case RouteItemType::WAIT:
+                writer
+                      .Key("stop_name"sv).Value(item.name)
+                      .Key("time"sv).Value(item.time)
+                      .Key("type"sv).Value("Wait"sv);
+                break;
+            case RouteItemType::BUS:
+                writer
+                      .Key("bus"sv).Value(item.name)
+                      .Key("span_count"sv).Value(item.span_count)
+                      .Key("time"sv).Value(item.time)
+                      .Key("type"sv).Value("Bus"sv);
+                break;
+            case RouteItemType::WALK:
+                writer.Key("distance"sv).Value(item.distance);
+                if (!item.name.empty()) {
+                    writer.Key("stop_name"sv).Value(item.name);
+                }
+                writer
+                      .Key("time"sv).Value(item.time)
+                      .Key("type"sv).Value("Walk"sv);
+                break;
         }
-        builder_
-                .Key("total_time"s).Value(total_time)
-                .Key("items"s).Value(items);
+        writer.EndDict();
     }
+    writer.EndArray();
+}
 
-    builder_.EndDict();
+bool GetFlag(const InputDict& req, const std::string& key) {
+    const auto it = req.find(key);
+    return it != req.end() && it->second.AsBool();
 }
 
-void StatRequests::PrintJsonDocument(const Array& arr_reqs, std::ostream& output) {
-    builder_.StartArray();
-    for (const Node& req : arr_reqs) {
-        const json::Dict& request = req.AsDict();
-        const std::string type = request.at("type").AsString();
+// "from" и "to" - имена остановок либо точки (latitude, longitude); от точек и к точкам
+// маршрут идет пешком через ближайшие остановки. С "departure_time" (минуты от начала суток)
+// между остановками ищется самое раннее прибытие по расписаниям автобусов.
+// Между остановками можно выбрать "fewest_transfers": из самых быстрых для каждого числа
+// пересадок - маршрут с наименьшим их числом, или "pareto": все такие маршруты в "routes"
+void StatRequests::HandleRouteRequest(const InputDict& req, json::Writer& writer) {
 
-        if (type == "Bus"s) {
-            HandleBusRequest(request);
-        } else if (type == "Stop"s) {
-            HandleStopRequest(request);
-        } else if (type == "Map"s) {
-            HandleMapRequest(request);
-        } else if (type == "Route"s) {
-            HandleRouteRequest(request);
+    writer.StartDict();
+
+    const int id = req.at("id"s).AsInt();
+
+    const InputNode& from = req.at("from");
+    const InputNode& to = req.at("to");
+    // ошибка в запросе - ответ с ее текстом; исключение оборвало бы уже начатый вывод
+    const auto write_error = [&writer, id](std::string_view message) {
+        writer.Key("error_message"sv).Value(message)
+        .Key("request_id"sv).Value(id);
+        writer.EndDict();
+    };
+    if (!(from.IsString() && to.IsString()) && !(from.IsDict() && to.IsDict())) {
+        write_error("route ends should be both stops or both points"sv);
+        return;
+    }
+    const bool is_pareto = GetFlag(req, "pareto"s);
+    const bool fewest_transfers = GetFlag(req, "fewest_transfers"s);
+    std::optional<double> departure_time;
+    if (req.count("departure_time")) {
+        departure_time = req.at("departure_time").AsDouble();
+    }
+    if ((departure_time || is_pareto || fewest_transfers) && !from.IsString()) {
+        write_error("departure time and route options are supported for routes between stops"sv);
+        return;
+    }
+
+    std::vector<RouteStat> routes;
+    if (is_pareto || fewest_transfers) {
+        routes = FindRoutes(from.AsString(), to.AsString(), departure_time);
+        if (!is_pareto && !routes.empty()) {
+            routes.resize(1);
+        }
+    } else {
+        std::optional<RouteStat> route_data;
+        if (departure_time) {
+            route_data = FindRoute(from.AsString(), to.AsString(), *departure_time);
+        } else if (from.IsString()) {
+            route_data = FindRoute(from.AsString(), to.AsString());
         } else {
-            throw std::invalid_argument("wrong request type");
+            route_data = FindRoute(GetPoint(from.AsDict()), GetPoint(to.AsDict()));
+        }
+        if (route_data) {
+            routes.push_back(std::move(*route_data));
         }
     }
-    builder_.EndArray();
-    Document out_document(builder_.Build());
-    Print(out_document, output);
-}
 
-std::vector<geo::Coordinates> GetAllCoordinates(const std::unordered_map<std::string_view, Stop*>& stops) {
-    std::vector<geo::Coordinates> coords;
-    coords.reserve(stops.size());
-    for (const auto& [nm, stop] : stops) {
-        if (!stop->buses.empty()) {
-            coords.push_back(stop->coordinates);
+    if (routes.empty()) {
+        writer.Key("error_message"sv).Value("not found"sv)
+        .Key("request_id"sv).Value(id);
+    } else if (is_pareto) {
+        writer.Key("request_id"sv).Value(id);
+        writer.Key("routes"sv).StartArray();
+        for (const RouteStat& route : routes) {
+            writer.StartDict();
+            WriteRouteItems(route, writer);
+            writer.Key("total_time"sv).Value(route.total_time);
+            writer.EndDict();
         }
+        writer.EndArray();
+    } else {
+        const RouteStat& route = routes.front();
+        WriteRouteItems(route, writer);
+        writer
+              .Key("request_id"sv).Value(id)
+              .Key("total_time"sv).Value(route.total_time);
     }
-    return coords;
+
+    writer.EndDict();
 }
 
-SphereProjector MakeProjector(const TransportCatalogue& db, const RenderSettings& settings) {
-    const std::unordered_map<std::string_view, Stop*>& stops = db.GetAllStops();
-    std::vector<geo::Coordinates> coords = GetAllCoordinates(stops);
-    
-    const renderer::SphereProjector proj{
-        coords.begin(), coords.end()
-        , settings.width
-        , settings.height
-        , settings.padding
-    };
+void StatRequests::HandleRequest(const InputDict& request, json::Writer& writer) {
+    const std::string_view type = request.at("type").AsString();
+
+    if (type == "Bus"s) {
+        HandleBusRequest(request, writer);
+    } else if (type == "Stop"s) {
+        HandleStopRequest(request, writer);
+    } else if (type == "Map"s) {
+        HandleMapRequest(request, writer);
+    } else if (type == "Route"s) {
+        HandleRouteRequest(request, writer);
+    } else if (type == "NearestStops"s) {
+        HandleNearestStopsRequest(request, writer);
+    } else if (type == "StopsInArea"s) {
+        HandleStopsInAreaRequest(request, writer);
+    } else {
+        throw std::invalid_argument("wrong request type");
+    }
+}
+
+void StatRequests::PrintJsonDocument(const InputArray& arr_reqs, std::ostream& output) {
+    json::Writer writer(output);
+    writer.StartArray();
+    for (const InputNode& req : arr_reqs) {
+        HandleRequest(req.AsDict(), writer);
+        writer.Flush();
+    }
+    writer.EndArray();
+}
+
+void StatRequests::PrintJsonDocument(json::Parser& parser, std::ostream& output) {
+    json::Writer writer(output);
+    writer.StartArray();
+    // один документ на все запросы: память арены переиспользуется от запроса к запросу
+    json::arena::Document request;
+    parser.StartArray();
+    while (parser.NextItem()) {
+        HandleRequest(request.Read(parser).AsDict(), writer);
+        // ответ уходит в поток сразу, как готов
+        writer.Flush();
+    }
+    writer.EndArray();
+}
+
+void PrintStatRequests(std::string_view stat_text, const t_c::CatalogueReader& catalogue
+                    , const RenderSettings& settings, const TransportRouter& router
+                    , std::ostream& output) {
+    StatRequests stat_reqs(catalogue, settings, router);
+    json::Parser parser(stat_text);
+    stat_reqs.PrintJsonDocument(parser, output);
+}
+
+// Значения корневого словаря исходным текстом. Массивы запросов разбираются потоково, когда
+// все нужное для них уже загружено, поэтому порядок ключей во входном документе не важен
+using RootSections = std::unordered_map<std::string, std::string_view>;
+
+RootSections SplitRoot(std::string_view text) {
+    RootSections sections;
+    json::Parser parser(text);
+    parser.StartDict();
+    while (const auto key = parser.NextKey()) {
+        std::string key_str(*key);
+        sections[std::move(key_str)] = parser.SkipValue();
+    }
+    return sections;
+}
+
+// настройки невелики, поэтому читаются в дерево
+json::arena::Document ParseSection(const RootSections& sections, const std::string& key) {
+    return json::arena::Load(sections.at(key));
+}
 
-    return proj;
+std::string GetSerializationFile(const RootSections& sections) {
+    const json::arena::Document settings = ParseSection(sections, "serialization_settings"s);
+    return std::string(settings.GetRoot().AsDict().at("file"s).AsString());
 }
 
 void LoadJSON(std::istream& input, std::ostream& output, TransportCatalogue& catalogue) {
-    const Document json_document = Load(input);
-    assert(json_document.GetRoot().IsDict());
+    const std::string text = json::ReadText(input);
+    const RootSections sections = SplitRoot(text);
 
-    const Dict all_reqs = json_document.GetRoot().AsDict();
+    json::Parser base_parser(sections.at("base_requests"s));
+    FillRequests fill_reqs(catalogue);
+    fill_reqs.ProcessBaseRequests(base_parser);
+
+    const json::arena::Document routing_settings_nd = ParseSection(sections, "routing_settings"s);
+    RoutingSettings routing_settings;
+    fill_reqs.ProcessRoutingSettings(routing_settings, routing_settings_nd.GetRoot().AsDict());
+    TransportRouter router(routing_settings, catalogue);
+
+    const json::arena::Document render_nd = ParseSection(sections, "render_settings"s);
+    renderer::RenderSettings settings;
+    fill_reqs.ProcessRenderRequests(render_nd.GetRoot().AsDict(), settings);
+
+    PrintStatRequests(sections.at("stat_requests"s), catalogue, settings, router, output);
+}
 
-    const Array& base_nd = all_reqs.at("base_requests"s).AsArray();
+void MakeBase(std::istream& input) {
+    const std::string text = json::ReadText(input);
+    const RootSections sections = SplitRoot(text);
+
+    TransportCatalogue catalogue;
+    json::Parser base_parser(sections.at("base_requests"s));
     FillRequests fill_reqs(catalogue);
-    fill_reqs.ProcessBaseRequests(base_nd);
+    fill_reqs.ProcessBaseRequests(base_parser);
 
-    const Dict& routing_settings_nd = all_reqs.at("routing_settings"s).AsDict();
+    const json::arena::Document routing_settings_nd = ParseSection(sections, "routing_settings"s);
     RoutingSettings routing_settings;
-    fill_reqs.ProcessRoutingSettings(routing_settings, routing_settings_nd);
+    fill_reqs.ProcessRoutingSettings(routing_settings, routing_settings_nd.GetRoot().AsDict());
     TransportRouter router(routing_settings, catalogue);
 
-    const Dict& render_nd = all_reqs.at("render_settings"s).AsDict();
+    const json::arena::Document render_nd = ParseSection(sections, "render_settings"s);
+    renderer::RenderSettings settings;
+    fill_reqs.ProcessRenderRequests(render_nd.GetRoot().AsDict(), settings);
+
+    const std::string file = GetSerializationFile(sections);
+    std::ofstream output(file, std::ios::binary);
+    if (!output) {
+        throw std::runtime_error("can't open "s + file);
+    }
+    serialization::SaveBase(output, catalogue, settings, router);
+    if (!output.flush()) {
+        throw std::runtime_error("can't write "s + file);
+    }
+}
+
+void ProcessRequests(std::istream& input, std::ostream& output) {
+    const std::string text = json::ReadText(input);
+    const RootSections sections = SplitRoot(text);
+
+    // запросы обслуживаются прямо из отображенного снимка, справочник в памяти не строится
+    const serialization::BaseSnapshot snapshot(GetSerializationFile(sections));
     renderer::RenderSettings settings;
-    fill_reqs.ProcessRenderRequests(render_nd, settings);
-    SphereProjector projector = MakeProjector(catalogue, settings);
-    MapRenderer renderer(settings, projector);
+    const std::unique_ptr<TransportRouter> router = snapshot.LoadRouter(settings);
 
-    const Array& stat_nd = all_reqs.at("stat_requests"s).AsArray();
-    StatRequests stat_reqs(catalogue, renderer, router);
-    stat_reqs.PrintJsonDocument(stat_nd, output);
+    PrintStatRequests(sections.at("stat_requests"s), snapshot.GetCatalogue(), settings, *router, output);
 }
 
 } // json_reader
@@ -1,8 +1,11 @@
 #pragma once
 #include <algorithm>
 #include <deque>
+#include <fstream>
 #include <cassert>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -14,13 +17,21 @@
 #include "domain.h"
 #include "geo.h"
 #include "json.h"
-#include "json_builder.h"
+#include "json_arena.h"
+#include "json_parser.h"
+#include "json_writer.h"
 #include "request_handler.h"
+#include "serialization.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
 namespace json_reader {
 
+// входные документы читаются в дерево на арене, ответы пишутся в поток через json::Writer
+using InputNode = json::arena::Node;
+using InputDict = json::arena::Dict;
+using InputArray = json::arena::Array;
+
 class FillRequests {
 private:
     struct StopData {
@@ -41,16 +52,30 @@ private:
         std::string name;
         std::deque<std::string> stops;
         bool is_roundtrip;
+        double velocity = 0;
+        std::vector<double> departures;
+    };
+
+    // необязательные поля автобуса: скорость и расписание - список отправлений
+    // либо интервал между отправлениями с first_departure по last_departure
+    struct BusSchedule {
+        std::optional<double> velocity;
+        std::optional<std::vector<double>> departures;
+        std::optional<double> headway;
+        std::optional<double> first_departure;
+        std::optional<double> last_departure;
     };
 
 public:
     FillRequests(t_c::TransportCatalogue& db);
 
-    void ProcessBaseRequests(const json::Array&);
-    void ProcessRenderRequests(const json::Dict&
+    void ProcessBaseRequests(const InputArray&);
+    // то же без построения дерева: запросы читаются из разборщика по одному
+    void ProcessBaseRequests(json::Parser&);
+    void ProcessRenderRequests(const InputDict&
                                     , renderer::RenderSettings&);
     void ProcessRoutingSettings(domain::RoutingSettings&
-                                    , const json::Dict&);
+                                    , const InputDict&);
 
     using RoadDistances = const std::unordered_map<std::string, double>;
 private:
@@ -59,8 +84,12 @@ private:
     t_c::TransportCatalogue& db_;
     domain::RoutingSettings routing_settings_;
 
-    void LoadBusRequest(const json::Dict&);
-    void LoadStopRequest(const json::Dict&);
+    void LoadBusRequest(const InputDict&);
+    void LoadStopRequest(const InputDict&);
+    void LoadRequest(json::Parser&);
+    void AddBusRequest(std::string name, const std::vector<std::string>& stops, bool is_round,
+                       const BusSchedule& schedule);
+    void ApplyRequests();
 
     void ApplyDistances(domain::Stop&, RoadDistances&);
 };
@@ -69,19 +98,30 @@ private:
 class StatRequests : public RequestHandler {
 public:
     StatRequests(
-                const t_c::TransportCatalogue&,
-                const renderer::MapRenderer&,
+                const t_c::CatalogueReader&,
+                const renderer::RenderSettings&,
                 const TransportRouter&);
-    void PrintJsonDocument(const json::Array&, std::ostream&);
+    void PrintJsonDocument(const InputArray&, std::ostream&);
+    // запросы читаются из разборщика по одному, дерево строится только для текущего запроса
+    void PrintJsonDocument(json::Parser&, std::ostream&);
 
 private:
-    json::Builder builder_;
-    void HandleBusRequest(const json::Dict&);
-    void HandleStopRequest(const json::Dict&);
-    void HandleMapRequest(const json::Dict&);
-    void HandleRouteRequest(const json::Dict&);
+    void HandleRequest(const InputDict&, json::Writer&);
+    void HandleBusRequest(const InputDict&, json::Writer&);
+    void HandleStopRequest(const InputDict&, json::Writer&);
+    void HandleMapRequest(const InputDict&, json::Writer&);
+    void HandleRouteRequest(const InputDict&, json::Writer&);
+    void HandleNearestStopsRequest(const InputDict&, json::Writer&);
+    void HandleStopsInAreaRequest(const InputDict&, json::Writer&);
 };
 
 void LoadJSON(std::istream&, std::ostream&, t_c::TransportCatalogue&);
 
+// make_base: строит справочник и маршрутизатор по base_requests и настройкам
+// и сохраняет их в файл из serialization_settings
+void MakeBase(std::istream&);
+
+// process_requests: загружает базу из файла serialization_settings и отвечает на stat_requests
+void ProcessRequests(std::istream&, std::ostream&);
+
 } // json_reader
@@ -0,0 +1,183 @@
+#include "json_writer.h"
+
+#include <stdexcept>
+
+#include "number_format.h"
+
+using namespace std::literals;
+
+namespace json {
+
+Writer::Writer(std::ostream& output)
+    : output_(output) {
+    buffer_.reserve(BUFFER_SIZE);
+}
+
+Writer::~Writer() {
+    // исключение из деструктора не выпускаем: незаписанный остаток теряется вместе с потоком
+    try {
+        Flush();
+    } catch (...) {
+    }
+}
+
+void Writer::Flush() {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    output_.flush();
+    buffer_.clear();
+}
+
+void Writer::Reserve() {
+    if (buffer_.size() >= BUFFER_SIZE) {
+        output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+}
+
+void Writer::WriteIndent(size_t depth) {
+    buffer_.append(depth * 4, ' ');
+}
+
+void Writer::BeginValue(const char* command) {
+    Reserve();
+    if (levels_.empty()) {
+        if (has_root_) {
+            throw std::logic_error(command + ": trying to add the second element without container"s);
+        }
+        has_root_ = true;
+        return;
+    }
+    Level& level = levels_.back();
+    if (level.is_dict) {
+        if (!after_key_) {
+            throw std::logic_error(command + ": trying to add a value without key"s);
+        }
+        after_key_ = false;
+        return;
+    }
+    if (level.has_items) {
+        buffer_ += ",\n"sv;
+    }
+    level.has_items = true;
+    WriteIndent(levels_.size());
+}
+
+void Writer::EndContainer(bool is_dict, const char* command) {
+    if (levels_.empty() || levels_.back().is_dict != is_dict || after_key_) {
+        throw std::logic_error(command + ": completion is not possible"s);
+    }
+    levels_.pop_back();
+    buffer_.push_back('\n');
+    WriteIndent(levels_.size());
+    buffer_.push_back(is_dict ? '}' : ']');
+}
+
+Writer& Writer::StartDict() {
+    BeginValue("StartDict");
+    levels_.push_back({true, false});
+    buffer_ += "{\n"sv;
+    return *this;
+}
+
+Writer& Writer::EndDict() {
+    EndContainer(true, "EndDict");
+    return *this;
+}
+
+Writer& Writer::StartArray() {
+    BeginValue("StartArray");
+    levels_.push_back({false, false});
+    buffer_ += "[\n"sv;
+    return *this;
+}
+
+Writer& Writer::EndArray() {
+    EndContainer(false, "EndArray");
+    return *this;
+}
+
+Writer& Writer::Key(std::string_view key) {
+    if (levels_.empty() || !levels_.back().is_dict) {
+        throw std::logic_error("Key: trying to create key outside dictionary"s);
+    }
+    if (after_key_) {
+        throw std::logic_error("Key: trying to add the second key immediately"s);
+    }
+    Reserve();
+    Level& level = levels_.back();
+    if (level.has_items) {
+        buffer_ += ",\n"sv;
+    }
+    level.has_items = true;
+    WriteIndent(levels_.size());
+    WriteString(key);
+    buffer_ += ": "sv;
+    after_key_ = true;
+    return *this;
+}
+
+Writer& Writer::Value(std::nullptr_t) {
+    BeginValue("Value");
+    buffer_ += "null"sv;
+    return *this;
+}
+
+Writer& Writer::Value(bool value) {
+    BeginValue("Value");
+    buffer_ += value ? "true"sv : "false"sv;
+    return *this;
+}
+
+Writer& Writer::Value(int value) {
+    BeginValue("Value");
+    number_format::Append(buffer_, value);
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeginValue("Value");
+    number_format::Append(buffer_, value);
+    return *this;
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeginValue("Value");
+    WriteString(value);
+    return *this;
+}
+
+void Writer::WriteString(std::string_view value) {
+    buffer_.push_back('"');
+    // символы без экранирования копируются участками; длинная строка (например, карта)
+    // уходит в поток по мере заполнения буфера, не накапливаясь в нем целиком
+    size_t run_begin = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char c = value[i];
+        if (c != '"' && c != '\\' && c != '\n' && c != '\r' && c != '\t') {
+            continue;
+        }
+        buffer_.append(value.data() + run_begin, i - run_begin);
+        run_begin = i + 1;
+        switch (c) {
+            case '\r':
+                buffer_ += "\\r"sv;
+                break;
+            case '\n':
+                buffer_ += "\\n"sv;
+                break;
+            case '\t':
+                buffer_ += "\\t"sv;
+                break;
+            default:
+                // символы " и \ выводятся как \" и \\ соответственно
+                buffer_.push_back('\\');
+                buffer_.push_back(c);
+                break;
+        }
+        Reserve();
+    }
+    buffer_.append(value.data() + run_begin, value.size() - run_begin);
+    buffer_.push_back('"');
+}
+
+}  // namespace json
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+// Пишет JSON сразу в поток, без построения дерева, в том же виде, что json::Print.
+// Интерфейс - как у Builder, порядок вызовов проверяется так же. Текст копится в буфере
+// и уходит в поток при заполнении буфера или по Flush(). Ключи словаря выводятся в порядке
+// вызовов Key, поэтому для совпадения с json::Print их нужно передавать по алфавиту
+class Writer {
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    explicit Writer(std::ostream& output);
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer();
+
+    Writer& StartDict();
+    Writer& EndDict();
+    Writer& StartArray();
+    Writer& EndArray();
+    Writer& Key(std::string_view key);
+
+    Writer& Value(std::nullptr_t);
+    Writer& Value(bool value);
+    Writer& Value(int value);
+    Writer& Value(double value);
+    Writer& Value(std::string_view value);
+    Writer& Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    // отдает накопленный текст в поток и сбрасывает поток
+    void Flush();
+
+private:
+    struct Level {
+        bool is_dict;
+        bool has_items;
+    };
+
+    // разделитель и отступ перед очередным значением; проверяет, что значение здесь допустимо
+    void BeginValue(const char* command);
+    void EndContainer(bool is_dict, const char* command);
+    void WriteIndent(size_t depth);
+    void WriteString(std::string_view value);
+    void Reserve();
+
+    std::ostream& output_;
+    std::string buffer_;
+    std::vector<Level> levels_;
+    bool after_key_ = false;
+    bool has_root_ = false;
+};
+
+}  // namespace json
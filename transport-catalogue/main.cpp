@@ -1,16 +1,38 @@
 #include <iostream>
 #include <fstream>
+#include <string_view>
 #include "json_reader.h"
 #include "transport_catalogue.h"
 // #include "duration/log_duration.h"
 
 using namespace std;
 using namespace t_c;
+using namespace std::literals;
 
-int main() {
-    {
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+}
+
+int main(int argc, char* argv[]) {
+    // без аргументов база строится и запросы обрабатываются за один запуск
+    if (argc == 1) {
         TransportCatalogue catalogue;
         json_reader::LoadJSON(cin, cout, catalogue);
+        return 0;
+    }
+    if (argc != 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::string_view mode(argv[1]);
+    if (mode == "make_base"sv) {
+        json_reader::MakeBase(cin);
+    } else if (mode == "process_requests"sv) {
+        json_reader::ProcessRequests(cin, cout);
+    } else {
+        PrintUsage();
+        return 1;
     }
 
     // {
@@ -22,11 +22,25 @@ namespace renderer {
     }
 
     /* --------------- MapRenderer --------------- */
-    MapRenderer::MapRenderer(const RenderSettings& set, const SphereProjector& proj)
-        : settings_(set), projector_(proj) {
+    MapRenderer::MapRenderer(const RenderSettings& set, const SphereProjector& proj
+                            , const MapViewport* viewport)
+        : settings_(set), projector_(proj), viewport_(viewport) {
     }
 
-    svg::Polyline MapRenderer::DrawRoad(Bus* bus_ptr, const svg::Color& color) const {
+    const RenderSettings& MapRenderer::GetSettings() const {
+        return settings_;
+    }
+
+    bool MapRenderer::IsVisible(const t_c::BusView& bus) const {
+        return viewport_ == nullptr || viewport_->buses.count(bus.id) > 0;
+    }
+
+    bool MapRenderer::IsVisible(const t_c::StopView& stop) const {
+        return viewport_ == nullptr || viewport_->area.Contains(stop.coordinates);
+    }
+
+    svg::Polyline MapRenderer::DrawRoad(const t_c::CatalogueReader& catalogue, const t_c::BusView& bus
+                , const svg::Color& color) const {
         svg::Polyline road = svg::Polyline()
                         .SetFillColor(svg::NoneColor)
                         .SetStrokeColor(color)
@@ -34,32 +48,25 @@ namespace renderer {
                         .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-        const auto& route = bus_ptr->route;
-        for (auto it = route.begin(); it != route.end(); ++it) {
-            road.AddPoint(projector_((*it)->coordinates));
+        for (const uint32_t stop_id : bus.route) {
+            road.AddPoint(projector_(catalogue.GetStop(stop_id).coordinates));
         }
         return road;
     }
 
-    std::set<std::string_view> GetBusNames(const std::unordered_map<std::string_view, Bus*>& buses) {
-        std::set<std::string_view> names;
-        for (const auto& [nm, value] : buses) {
-            names.insert(nm);
-        }
-        return names;
-    }
-
-    void MapRenderer::MakeRoadsLayot(BusesMapRef buses
-            , const std::set<std::string_view>& sorted_names
-            , svg::ObjectContainer& doc) const {
+    void MapRenderer::MakeRoadsLayot(const t_c::CatalogueReader& catalogue
+            , svg::Document& doc) const {
 
         size_t p_counter = 0;
         auto palette = settings_.color_palette;
-        for (const auto& name : sorted_names) {
-            Bus* bus = buses.at(name);
+        for (const uint32_t bus_id : catalogue.GetBusesByName()) {
+            const t_c::BusView bus = catalogue.GetBus(bus_id);
 
-            if (bus->route.size() != 0) {
-                doc.Add(DrawRoad(bus, palette.at(p_counter)));
+            if (!bus.route.empty()) {
+                // цвет расходуется и на невидимые маршруты, чтобы совпадать с полной картой
+                if (IsVisible(bus)) {
+                    doc.Add(DrawRoad(catalogue, bus, palette.at(p_counter)));
+                }
 
                 if (p_counter == palette.size() - 1) {
                     p_counter = 0;
@@ -79,57 +86,60 @@ namespace renderer {
             .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
     }
 
-    void MapRenderer::SetBaseBusAttrs(Stop* stop_ptr, Bus* bus_ptr, svg::Text& text) const {
+    void MapRenderer::SetBaseBusAttrs(const t_c::StopView& stop, const t_c::BusView& bus, svg::Text& text) const {
         text
-            .SetPosition(projector_(stop_ptr->coordinates))
+            .SetPosition(projector_(stop.coordinates))
             .SetOffset(settings_.bus_label_offset)
             .SetFontSize(settings_.bus_label_font_size)
             .SetFontFamily("Verdana")
             .SetFontWeight("bold")
-            .SetData(bus_ptr->name);
+            .SetData(std::string(bus.name));
     }
-    void MapRenderer::DrawBusName(Bus* bus_ptr, const svg::Color& color
-                    , svg::ObjectContainer& doc) const {
-        Stop* stop_first = bus_ptr->route.at(0);
+    void MapRenderer::DrawBusName(const t_c::CatalogueReader& catalogue, const t_c::BusView& bus
+                    , const svg::Color& color, svg::Document& doc) const {
+        const t_c::StopView stop_first = catalogue.GetStop(*bus.route.begin());
         
         svg::Text text_first = svg::Text();
         SetTextAttrs(text_first);
-        SetBaseBusAttrs(stop_first, bus_ptr, text_first);
+        SetBaseBusAttrs(stop_first, bus, text_first);
         
         svg::Text overlay_first = svg::Text().SetFillColor(color);
-        SetBaseBusAttrs(stop_first, bus_ptr, overlay_first);
+        SetBaseBusAttrs(stop_first, bus, overlay_first);
         
-        doc.Add(text_first);
-        doc.Add(overlay_first);
+        if (IsVisible(stop_first)) {
+            doc.Add(text_first);
+            doc.Add(overlay_first);
+        }
 
         svg::Text text = svg::Text().SetFillColor("black");
-        if (!bus_ptr->is_roundtrip) {
-            size_t index = std::floor(bus_ptr->route.size() / 2.0);
-            Stop* stop_second = bus_ptr->route.at(index);
-            if (stop_first == stop_second) { return; }
+        if (!bus.is_roundtrip) {
+            size_t index = std::floor(bus.route.size() / 2.0);
+            const t_c::StopView stop_second = catalogue.GetStop(bus.route.begin()[index]);
+            if (stop_first.id == stop_second.id || !IsVisible(stop_second)) { return; }
 
             svg::Text text_second = svg::Text();
             SetTextAttrs(text_second);
-            SetBaseBusAttrs(stop_second, bus_ptr, text_second);
+            SetBaseBusAttrs(stop_second, bus, text_second);
             
             svg::Text overlay_second = svg::Text().SetFillColor(color);
-            SetBaseBusAttrs(stop_second, bus_ptr, overlay_second);
+            SetBaseBusAttrs(stop_second, bus, overlay_second);
             
             doc.Add(text_second);
             doc.Add(overlay_second);
         }
     }
-    void MapRenderer::MakeBusNamesLayot(BusesMapRef buses
-            , const std::set<std::string_view>& sorted_names
-            , svg::ObjectContainer& doc) const {
+    void MapRenderer::MakeBusNamesLayot(const t_c::CatalogueReader& catalogue
+            , svg::Document& doc) const {
 
         size_t p_counter = 0;
         auto palette = settings_.color_palette;
-        for (const auto& name : sorted_names) {
-            Bus* bus_ptr = buses.at(name);
+        for (const uint32_t bus_id : catalogue.GetBusesByName()) {
+            const t_c::BusView bus = catalogue.GetBus(bus_id);
 
-            if (bus_ptr->route.size() != 0) {
-                DrawBusName(bus_ptr, palette.at(p_counter), doc);
+            if (!bus.route.empty()) {
+                if (IsVisible(bus)) {
+                    DrawBusName(catalogue, bus, palette.at(p_counter), doc);
+                }
 
                 if (p_counter == palette.size() - 1) {
                     p_counter = 0;
@@ -140,44 +150,44 @@ namespace renderer {
         }
     }
 
-    svg::Circle MapRenderer::DrawCircle(domain::Stop* stop_ptr) const {
+    svg::Circle MapRenderer::DrawCircle(const t_c::StopView& stop) const {
         return svg::Circle()
-                .SetCenter(projector_(stop_ptr->coordinates))
+                .SetCenter(projector_(stop.coordinates))
                 .SetRadius(settings_.stop_radius)
                 .SetFillColor("white");
     }
-    void MapRenderer::MakeCirclesLayot(std::vector<domain::Stop*> stops
-            , svg::ObjectContainer& doc) const {
-        for (Stop* stop_ptr : stops) {
-            doc.Add(DrawCircle(stop_ptr));
+    void MapRenderer::MakeCirclesLayot(const std::vector<t_c::StopView>& stops
+            , svg::Document& doc) const {
+        for (const t_c::StopView& stop : stops) {
+            doc.Add(DrawCircle(stop));
         }
     }
 
 
-    void MapRenderer::SetBaseStopAttrs(domain::Stop* stop_ptr, svg::Text& text) const {
+    void MapRenderer::SetBaseStopAttrs(const t_c::StopView& stop, svg::Text& text) const {
         text
-            .SetPosition(projector_(stop_ptr->coordinates))
+            .SetPosition(projector_(stop.coordinates))
             .SetOffset(settings_.stop_label_offset)
             .SetFontSize(settings_.stop_label_font_size)
             .SetFontFamily("Verdana")
-            .SetData(stop_ptr->name);
+            .SetData(std::string(stop.name));
     }
-    void MapRenderer::DrawStopName(Stop* stop_ptr
-                    , svg::ObjectContainer& doc) const {
+    void MapRenderer::DrawStopName(const t_c::StopView& stop
+                    , svg::Document& doc) const {
         svg::Text text = svg::Text();
         SetTextAttrs(text);
-        SetBaseStopAttrs(stop_ptr, text);
+        SetBaseStopAttrs(stop, text);
 
         svg::Text overlay = svg::Text().SetFillColor("black");
-        SetBaseStopAttrs(stop_ptr, overlay);
+        SetBaseStopAttrs(stop, overlay);
 
         doc.Add(text);
         doc.Add(overlay);
     }
-    void MapRenderer::MakeStopNamesLayot(std::vector<domain::Stop*> stops
-            , svg::ObjectContainer& doc) const {
-        for (Stop* stop_ptr : stops) {
-            DrawStopName(stop_ptr, doc);
+    void MapRenderer::MakeStopNamesLayot(const std::vector<t_c::StopView>& stops
+            , svg::Document& doc) const {
+        for (const t_c::StopView& stop : stops) {
+            DrawStopName(stop, doc);
         }
     }
 
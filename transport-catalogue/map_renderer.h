@@ -5,9 +5,11 @@
 #include <optional>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <cmath>
 #include <set>
 
+#include "catalogue_reader.h"
 #include "geo.h"
 #include "domain.h"
 #include "svg.h"
@@ -102,39 +104,51 @@ struct RenderSettings {
     double underlayer_width = 0;    
 };
 
+// Часть карты: выводятся только маршруты автобусов с номерами из buses, а их подписи - только
+// у конечных остановок внутри area. Цвета маршрутов остаются такими же, как на всей карте
+struct MapViewport {
+    geo::Rect area;
+    std::unordered_set<uint32_t> buses;
+};
+
 class MapRenderer {
 public:
-    MapRenderer(const RenderSettings& set, const SphereProjector& proj);
+    MapRenderer(const RenderSettings& set, const SphereProjector& proj
+                , const MapViewport* viewport = nullptr);
 
-    using BusesMapRef = const std::unordered_map<std::string_view, domain::Bus*>&;
-    
-    void MakeRoadsLayot(BusesMapRef buses
-            , const std::set<std::string_view>& sorted_names
-            , svg::ObjectContainer& doc) const;
+    const RenderSettings& GetSettings() const;
 
-    void MakeBusNamesLayot(BusesMapRef buses
-            , const std::set<std::string_view>& sorted_names
-            , svg::ObjectContainer& doc) const;
+    // маршруты всех автобусов справочника по возрастанию имени
+    void MakeRoadsLayot(const t_c::CatalogueReader& catalogue
+            , svg::Document& doc) const;
 
-    void MakeCirclesLayot(std::vector<domain::Stop*> stops
-            , svg::ObjectContainer& doc) const;
+    void MakeBusNamesLayot(const t_c::CatalogueReader& catalogue
+            , svg::Document& doc) const;
 
-    void MakeStopNamesLayot(std::vector<domain::Stop*> stops
-            , svg::ObjectContainer& doc) const;
+    void MakeCirclesLayot(const std::vector<t_c::StopView>& stops
+            , svg::Document& doc) const;
+
+    void MakeStopNamesLayot(const std::vector<t_c::StopView>& stops
+            , svg::Document& doc) const;
 
 private:
     const RenderSettings& settings_;
     const SphereProjector& projector_;
-
-    svg::Polyline DrawRoad(domain::Bus* bus_ptr, const svg::Color& color) const;
-    void DrawBusName(domain::Bus* bus_ptr, const svg::Color& color
-                    , svg::ObjectContainer& doc) const;
-    svg::Circle DrawCircle(domain::Stop* stop_ptr) const;
-    void DrawStopName(domain::Stop* stop_ptr
-                , svg::ObjectContainer& doc) const;
+    const MapViewport* viewport_;
+
+    bool IsVisible(const t_c::BusView& bus) const;
+    bool IsVisible(const t_c::StopView& stop) const;
+
+    svg::Polyline DrawRoad(const t_c::CatalogueReader& catalogue, const t_c::BusView& bus
+                , const svg::Color& color) const;
+    void DrawBusName(const t_c::CatalogueReader& catalogue, const t_c::BusView& bus
+                , const svg::Color& color, svg::Document& doc) const;
+    svg::Circle DrawCircle(const t_c::StopView& stop) const;
+    void DrawStopName(const t_c::StopView& stop
+                , svg::Document& doc) const;
     
-    void SetBaseStopAttrs(domain::Stop* stop_ptr, svg::Text& text) const;
-    void SetBaseBusAttrs(domain::Stop* stop_ptr, domain::Bus* bus_ptr, svg::Text& text) const;
+    void SetBaseStopAttrs(const t_c::StopView& stop, svg::Text& text) const;
+    void SetBaseBusAttrs(const t_c::StopView& stop, const t_c::BusView& bus, svg::Text& text) const;
     void SetTextAttrs(svg::Text& text) const;
 };
 
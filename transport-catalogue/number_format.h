@@ -0,0 +1,56 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+// Вывод чисел через std::to_chars в буфер на стеке - без локали и виртуальных вызовов
+// std::num_put. Дробные числа выводятся в общем формате с 6 значащими цифрами: побайтно
+// так же, как std::ostream с настройками по умолчанию (и printf "%g")
+namespace number_format {
+
+// хватает для любого double с точностью 6 и любого 64-битного целого
+constexpr size_t MAX_SIZE = 32;
+
+inline char* Format(char* first, char* last, double value) {
+    return std::to_chars(first, last, value, std::chars_format::general, 6).ptr;
+}
+
+template <typename Int, std::enable_if_t<std::is_integral_v<Int>, int> = 0>
+char* Format(char* first, char* last, Int value) {
+    return std::to_chars(first, last, value).ptr;
+}
+
+template <typename T>
+void Append(std::string& out, T value) {
+    char buffer[MAX_SIZE];
+    const char* end = Format(buffer, buffer + MAX_SIZE, value);
+    out.append(buffer, static_cast<size_t>(end - buffer));
+}
+
+template <typename T>
+void Write(std::ostream& out, T value) {
+    char buffer[MAX_SIZE];
+    const char* end = Format(buffer, buffer + MAX_SIZE, value);
+    out.write(buffer, end - buffer);
+}
+
+// Обертка для вывода в поток оператором <<: out << Number(x)
+template <typename T>
+struct Number {
+    explicit Number(T value)
+        : value(value) {
+    }
+
+    T value;
+};
+
+template <typename T>
+std::ostream& operator<<(std::ostream& out, Number<T> number) {
+    Write(out, number.value);
+    return out;
+}
+
+}  // namespace number_format
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Число потоков для параллельных вычислений: по числу ядер, но не меньше одного
+inline size_t GetThreadCount() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Вызывает func(index) для всех index из [0, count), разбивая диапазон на непрерывные
+// блоки по потокам. Порядок вызовов внутри блока сохраняется; первое исключение
+// из любого потока пробрасывается вызывающему после завершения всех потоков
+template <typename Func>
+void ForEachIndex(size_t count, Func func) {
+    const size_t thread_count = std::min(GetThreadCount(), count);
+    if (thread_count <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            func(index);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(thread_count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    const size_t block_size = (count + thread_count - 1) / thread_count;
+    for (size_t thread_index = 0; thread_index < thread_count; ++thread_index) {
+        const size_t begin = thread_index * block_size;
+        const size_t end = std::min(count, begin + block_size);
+        threads.emplace_back([&func, &errors, thread_index, begin, end] {
+            try {
+                for (size_t index = begin; index < end; ++index) {
+                    func(index);
+                }
+            } catch (...) {
+                errors[thread_index] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace parallel
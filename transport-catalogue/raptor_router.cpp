@@ -0,0 +1,267 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace domain;
+using namespace t_c;
+
+RaptorRouter::RaptorRouter(const RoutingSettings& routing_settings,
+                           const CatalogueReader& catalogue)
+    : routing_settings_(routing_settings), catalogue_(catalogue) {
+    // остановки и маршруты нумеруются как в справочнике
+    const size_t stops_count = catalogue.GetStopsCount();
+    std::vector<uint32_t> stop_routes_count(stops_count, 0);
+    routes_.reserve(catalogue.GetBusesCount());
+    for (uint32_t bus_id = 0; bus_id < catalogue.GetBusesCount(); ++bus_id) {
+        const BusView bus = catalogue.GetBus(bus_id);
+        const uint32_t begin = static_cast<uint32_t>(route_stops_.size());
+        const double* road = catalogue.GetBusRouteLengths(bus_id).road.begin();
+        for (const uint32_t stop_id : bus.route) {
+            route_distances_.push_back(*road);
+            route_times_.push_back(ComputeRoadTimeInMinutes(*road, bus.velocity));
+            route_stops_.push_back(stop_id);
+            ++stop_routes_count[stop_id];
+            ++road;
+        }
+        routes_.push_back({bus, begin, static_cast<uint32_t>(route_stops_.size())});
+    }
+
+    stop_routes_begin_.assign(stops_count + 1, 0);
+    for (size_t stop_id = 0; stop_id < stops_count; ++stop_id) {
+        stop_routes_begin_[stop_id + 1] = stop_routes_begin_[stop_id] + stop_routes_count[stop_id];
+    }
+    stop_routes_.resize(route_stops_.size());
+    std::vector<uint32_t> next = stop_routes_begin_;
+    for (uint32_t route_id = 0; route_id < routes_.size(); ++route_id) {
+        for (uint32_t position = routes_[route_id].begin; position < routes_[route_id].end; ++position) {
+            stop_routes_[next[route_stops_[position]]++] = {route_id, position};
+        }
+    }
+
+    search_data_.stop_sources.assign(stops_count, 0);
+    search_data_.source_times.assign(stops_count, NO_TIME);
+    search_data_.stop_targets.assign(stops_count, 0);
+    search_data_.target_times.assign(stops_count, NO_TIME);
+    search_data_.arrivals[0].assign(stops_count, NO_TIME);
+    search_data_.arrivals[1].assign(stops_count, NO_TIME);
+    search_data_.best_arrivals.assign(stops_count, NO_TIME);
+    search_data_.legs.resize(stops_count);
+    search_data_.leg_indices.assign(stops_count, 0);
+    search_data_.is_marked.assign(stops_count, false);
+    search_data_.first_positions.assign(routes_.size(), NO_POSITION);
+}
+
+double RaptorRouter::ComputeRoadTimeInMinutes(double distance, double bus_velocity) const {
+    static const double METERS_IN_KILOMETER = 1000;
+    static const double MINUTES_IN_HOUR = 60;
+    const double velocity = bus_velocity > 0 ? bus_velocity : routing_settings_.velocity;
+    return distance / (velocity * METERS_IN_KILOMETER / MINUTES_IN_HOUR);
+}
+
+RaptorRouter::Boarding RaptorRouter::FindBoarding(const Route& route, uint32_t position, double arrival,
+                                                  bool use_timetables) const {
+    const TimeRange& departures = route.bus.departures;
+    if (!use_timetables || departures.empty()) {
+        return {arrival + routing_settings_.wait_time - route_times_[position], routing_settings_.wait_time};
+    }
+    const auto it = std::lower_bound(departures.begin(), departures.end(), arrival - route_times_[position]);
+    if (it == departures.end()) {
+        return {NO_TIME, 0};
+    }
+    return {*it, *it + route_times_[position] - arrival};
+}
+
+void RaptorRouter::MapTerminals(const std::vector<Terminal>& terminals, std::vector<size_t>& stop_terminals,
+                                std::vector<double>& times) const {
+    for (size_t i = 0; i < terminals.size(); ++i) {
+        const uint32_t stop_id = terminals[i].stop_id;
+        if (terminals[i].time < times[stop_id]) {
+            times[stop_id] = terminals[i].time;
+            stop_terminals[stop_id] = i;
+        }
+    }
+}
+
+std::vector<RaptorRouter::Journey> RaptorRouter::FindJourneys(const std::vector<Terminal>& sources,
+                                                              const std::vector<Terminal>& targets,
+                                                              bool use_timetables) const {
+    // номера проверяются до того, как что-нибудь записано в рабочие массивы
+    const size_t stops_count = catalogue_.GetStopsCount();
+    for (const std::vector<Terminal>* terminals : {&sources, &targets}) {
+        for (const Terminal& terminal : *terminals) {
+            if (terminal.stop_id >= stops_count) {
+                throw std::out_of_range("unknown stop");
+            }
+        }
+    }
+    SearchData& data = search_data_;
+    MapTerminals(sources, data.stop_sources, data.source_times);
+    MapTerminals(targets, data.stop_targets, data.target_times);
+
+    // Прибытия прошлого и текущего раундов чередуются в двух массивах; перед раундом из его
+    // массива стираются прибытия позапрошлого. От раундов остаются только поездки к улучшенным
+    // остановкам: по ним восстанавливается путь.
+    // best_arrivals - лучшие по всем раундам, best_total - лучшее прибытие к цели: время от
+    // конца до цели неотрицательно, поэтому прибытие хуже любого из них ничего не улучшит
+    std::vector<double>* arrivals = data.arrivals;
+    std::vector<double>& best_arrivals = data.best_arrivals;
+    std::vector<std::vector<Leg>> round_legs{{}};
+    double best_total = NO_TIME;
+
+    // найденные варианты: раунд, остановка конца, номер поездки к ней в раунде и прибытие к цели
+    struct Found {
+        size_t round;
+        uint32_t stop;
+        uint32_t leg;
+        double arrival;
+    };
+    std::vector<Found> found;
+
+    std::vector<uint32_t> source_stops;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (data.stop_sources[sources[i].stop_id] == i && data.source_times[sources[i].stop_id] != NO_TIME) {
+            source_stops.push_back(sources[i].stop_id);
+        }
+    }
+    std::sort(source_stops.begin(), source_stops.end());
+    for (const uint32_t stop_id : source_stops) {
+        arrivals[0][stop_id] = data.source_times[stop_id];
+        best_arrivals[stop_id] = data.source_times[stop_id];
+        const double total = data.source_times[stop_id] + data.target_times[stop_id];
+        if (total < best_total) {
+            best_total = total;
+            found.assign(1, {0, stop_id, 0, total});
+        }
+    }
+
+    std::vector<uint32_t> marked_stops = source_stops;
+    std::vector<uint32_t> marked_routes;
+
+    for (size_t round = 1; !marked_stops.empty(); ++round) {
+        for (const uint32_t stop_id : marked_stops) {
+            data.is_marked[stop_id] = false;
+            for (uint32_t i = stop_routes_begin_[stop_id]; i < stop_routes_begin_[stop_id + 1]; ++i) {
+                const auto [route_id, position] = stop_routes_[i];
+                if (data.first_positions[route_id] == NO_POSITION) {
+                    marked_routes.push_back(route_id);
+                }
+                data.first_positions[route_id] = std::min(data.first_positions[route_id], position);
+            }
+        }
+        marked_stops.clear();
+
+        const std::vector<double>& previous = arrivals[(round - 1) % 2];
+        std::vector<double>& current = arrivals[round % 2];
+        if (round == 2) {
+            for (const uint32_t stop_id : source_stops) {
+                current[stop_id] = NO_TIME;
+            }
+        }
+        if (round >= 2) {
+            for (const Leg& leg : round_legs[round - 2]) {
+                current[leg.stop] = NO_TIME;
+            }
+        }
+
+        // раунд 0 - вариант в этом раунде не найден
+        Found round_best{0, 0, 0, NO_TIME};
+        for (const uint32_t route_id : marked_routes) {
+            const Route& route = routes_[route_id];
+            double trip_start = NO_TIME;
+            uint32_t board_position = NO_POSITION;
+            uint32_t board_leg = 0;
+            double wait = 0;
+            for (uint32_t position = data.first_positions[route_id]; position < route.end; ++position) {
+                const uint32_t stop_id = route_stops_[position];
+                const double trip_time = trip_start + route_times_[position];
+                if (trip_time < std::min(best_arrivals[stop_id], best_total)) {
+                    current[stop_id] = trip_time;
+                    best_arrivals[stop_id] = trip_time;
+                    data.legs[stop_id] = {stop_id, route_id, board_position, position, board_leg, trip_start, wait};
+                    if (!data.is_marked[stop_id]) {
+                        data.is_marked[stop_id] = true;
+                        marked_stops.push_back(stop_id);
+                    }
+                    if (const double total = trip_time + data.target_times[stop_id]; total < best_total) {
+                        best_total = total;
+                        round_best = {round, stop_id, 0, total};
+                    }
+                }
+                // пересесть на более ранний рейс того же маршрута: возможно, только если
+                // на остановку пришли раньше, чем туда приходит текущий рейс
+                const double arrival = previous[stop_id];
+                if (arrival < trip_time) {
+                    const Boarding boarding = FindBoarding(route, position, arrival, use_timetables);
+                    if (boarding.trip_start < trip_start) {
+                        trip_start = boarding.trip_start;
+                        board_position = position;
+                        board_leg = data.leg_indices[stop_id];
+                        wait = boarding.wait;
+                    }
+                }
+            }
+            data.first_positions[route_id] = NO_POSITION;
+        }
+        marked_routes.clear();
+
+        std::vector<Leg>& legs = round_legs.emplace_back();
+        legs.reserve(marked_stops.size());
+        for (const uint32_t stop_id : marked_stops) {
+            data.leg_indices[stop_id] = static_cast<uint32_t>(legs.size());
+            legs.push_back(data.legs[stop_id]);
+        }
+        // вариант раунда записывается, только если он раньше всех прежних
+        if (round_best.round != 0) {
+            round_best.leg = data.leg_indices[round_best.stop];
+            found.push_back(round_best);
+        }
+    }
+
+    std::vector<Journey> journeys;
+    journeys.reserve(found.size());
+    for (const auto& [found_round, found_stop, found_leg, arrival] : found) {
+        Journey& journey = journeys.emplace_back();
+        journey.target = data.stop_targets[found_stop];
+        journey.arrival = arrival;
+        uint32_t stop_id = found_stop;
+        uint32_t leg_index = found_leg;
+        for (size_t round = found_round; round > 0; --round) {
+            const Leg& leg = round_legs[round][leg_index];
+            const uint32_t board_stop_id = route_stops_[leg.board_position];
+            const BusView& bus = routes_[leg.route].bus;
+            const double distance = route_distances_[leg.alight_position] - route_distances_[leg.board_position];
+            journey.items.push_back({RouteItemType::BUS, bus.name,
+                                     static_cast<int>(leg.alight_position - leg.board_position),
+                                     ComputeRoadTimeInMinutes(distance, bus.velocity)});
+            journey.items.push_back({RouteItemType::WAIT, catalogue_.GetStop(board_stop_id).name, 0, leg.wait});
+            stop_id = board_stop_id;
+            leg_index = leg.board_leg;
+        }
+        journey.source = data.stop_sources[stop_id];
+        std::reverse(journey.items.begin(), journey.items.end());
+    }
+
+    // в исходное состояние возвращаются только остановки, которых касался поиск;
+    // отметки остановок и маршрутов снимаются по ходу раундов
+    for (const Terminal& source : sources) {
+        data.source_times[source.stop_id] = NO_TIME;
+    }
+    for (const Terminal& target : targets) {
+        data.target_times[target.stop_id] = NO_TIME;
+    }
+    const auto reset_stop = [&data](uint32_t stop_id) {
+        data.arrivals[0][stop_id] = NO_TIME;
+        data.arrivals[1][stop_id] = NO_TIME;
+        data.best_arrivals[stop_id] = NO_TIME;
+    };
+    for (const uint32_t stop_id : source_stops) {
+        reset_stop(stop_id);
+    }
+    for (const std::vector<Leg>& legs : round_legs) {
+        for (const Leg& leg : legs) {
+            reset_stop(leg.stop);
+        }
+    }
+    return journeys;
+}
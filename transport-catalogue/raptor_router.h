@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+#include "catalogue_reader.h"
+
+// Поиск маршрутов по раундам (RAPTOR) прямо по массивам остановок автобусов, без графа.
+// Раунд k находит самые ранние прибытия на остановки ровно с k поездками: каждый автобус,
+// у которого в прошлом раунде улучшилась какая-нибудь остановка, просматривается один раз
+// от первой такой остановки. На автобус с расписанием садятся на первый еще не ушедший рейс,
+// автобус без расписания отправляется через bus_wait_time после прихода на остановку.
+// Предподсчет - только массивы маршрутов, память линейна по их суммарной длине
+class RaptorRouter {
+public:
+    // начало поиска: номер остановки и момент, когда пассажир на ней; конец: номер
+    // остановки и время, за которое от нее добираются до цели
+    struct Terminal {
+        uint32_t stop_id;
+        double time;
+    };
+
+    // найденный вариант: номера начала и конца, момент прибытия к цели и элементы
+    // Wait и Bus; ожидание - время до отправления рейса
+    struct Journey {
+        size_t source;
+        size_t target;
+        double arrival;
+        std::vector<domain::RouteItem> items;
+    };
+
+    RaptorRouter(const domain::RoutingSettings&, const t_c::CatalogueReader&);
+
+    // Варианты, оптимальные по числу поездок и времени прибытия: по возрастанию числа
+    // поездок, каждый следующий прибывает строго раньше предыдущего. Первый - с наименьшим
+    // числом поездок, последний - с самым ранним прибытием. Без use_timetables у всех
+    // автобусов вместо расписания ожидание bus_wait_time
+    std::vector<Journey> FindJourneys(const std::vector<Terminal>& sources,
+                                      const std::vector<Terminal>& targets,
+                                      bool use_timetables) const;
+
+private:
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+    static constexpr double NO_TIME = std::numeric_limits<double>::infinity();
+
+    // маршрут автобуса: отрезок [begin, end) в массивах остановок маршрутов
+    struct Route {
+        t_c::BusView bus;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // поездка, которой остановка достигнута в раунде: рейс, вышедший с начала маршрута
+    // в trip_start, посадка и выход - позиции на маршруте, wait - ожидание при посадке,
+    // board_leg - номер поездки к остановке посадки среди поездок прошлого раунда
+    struct Leg {
+        uint32_t stop;
+        uint32_t route;
+        uint32_t board_position;
+        uint32_t alight_position;
+        uint32_t board_leg;
+        double trip_start;
+        double wait;
+    };
+
+    // Рабочие массивы поиска по остановкам и маршрутам. Выделяются один раз на роутер,
+    // после поиска в исходное состояние возвращаются только затронутые им элементы,
+    // поэтому FindJourneys нельзя вызывать из нескольких потоков одновременно
+    struct SearchData {
+        // для каждой остановки номер начала (конца) с наименьшим временем на ней и это
+        // время; у остановок не из начал (концов) время NO_TIME, а номер не определен
+        std::vector<size_t> stop_sources;
+        std::vector<double> source_times;
+        std::vector<size_t> stop_targets;
+        std::vector<double> target_times;
+        // прибытия прошлого и текущего раундов и лучшие по всем раундам, NO_TIME - нет прибытия
+        std::vector<double> arrivals[2];
+        std::vector<double> best_arrivals;
+        // поездка текущего раунда к остановке и номер поездки к ней среди поездок ее раунда
+        std::vector<Leg> legs;
+        std::vector<uint32_t> leg_indices;
+        std::vector<bool> is_marked;
+        // первая позиция маршрута, с которой его нужно просмотреть в текущем раунде
+        std::vector<uint32_t> first_positions;
+    };
+
+    // посадка на рейс: время его отправления с начала маршрута и ожидание на остановке
+    struct Boarding {
+        double trip_start;
+        double wait;
+    };
+
+    // самый ранний рейс маршрута, на который можно сесть в позиции, придя в момент arrival
+    Boarding FindBoarding(const Route& route, uint32_t position, double arrival, bool use_timetables) const;
+
+    // записывает в stop_terminals и times номера начал (концов) с наименьшим временем
+    // на остановках и эти времена
+    void MapTerminals(const std::vector<Terminal>& terminals, std::vector<size_t>& stop_terminals,
+                      std::vector<double>& times) const;
+
+    double ComputeRoadTimeInMinutes(double distance, double bus_velocity) const;
+
+    const domain::RoutingSettings routing_settings_;
+    const t_c::CatalogueReader& catalogue_;
+    // маршруты по номерам автобусов
+    std::vector<Route> routes_;
+    // остановки маршрутов подряд, расстояние и время пути от начала маршрута до каждой;
+    // время поездки в ответе считается по расстоянию, как у ребер графа
+    std::vector<uint32_t> route_stops_;
+    std::vector<double> route_distances_;
+    std::vector<double> route_times_;
+    // маршруты через остановку и позиции на них:
+    // отрезок [stop_routes_begin_[id], stop_routes_begin_[id + 1])
+    std::vector<uint32_t> stop_routes_begin_;
+    std::vector<std::pair<uint32_t, uint32_t>> stop_routes_;
+
+    mutable SearchData search_data_;
+};
@@ -3,112 +3,243 @@
 using namespace domain;
 
 RequestHandler::RequestHandler (
-        const t_c::TransportCatalogue& db,
-        const renderer::MapRenderer& renderer,
+        const t_c::CatalogueReader& db,
+        const renderer::RenderSettings& render_settings,
         const TransportRouter& router
     )
-    : db_(db), renderer_(renderer), router_(router) {
+    : db_(db), render_settings_(render_settings), router_(router) {
 }
 
-struct StopPtrHasher {
-    size_t operator()(const Stop* stop) const {
-        return (size_t)stop;
-    }
-};
-
 std::optional<BusStat> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
-    Bus& bus = db_.FindBus(bus_name);
-    if (bus.IsEmpty()) {
+    const std::optional<uint32_t> bus_id = db_.FindBusId(bus_name);
+    if (!bus_id) {
         return std::nullopt;
     }
-    std::vector<Stop*>& route = bus.route;
+    return db_.GetBusStat(*bus_id);
+}
 
-    // all stops
-    int route_count = static_cast<int>(route.size());
+std::optional<t_c::IdRange>
+RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+    const std::optional<uint32_t> stop_id = db_.FindStopId(stop_name);
+    if (!stop_id) {
+        return std::nullopt;
+    }
+    return db_.GetStopBuses(*stop_id);
+}
 
-    // unique stops
-    std::unordered_set<Stop*, StopPtrHasher> unique_stops(bus.route.begin(), bus.route.end());
-    int unique_count = static_cast<int>(unique_stops.size());
+const t_c::CatalogueReader& RequestHandler::GetCatalogue() const {
+    return db_;
+}
 
-    // route length
-    double geographical_length = 0;
-    for (size_t i = 0; i < route.size(); ++i) {
-        if (i == route.size() - 1) {
-            break;
+// остановки маршрутов по возрастанию имени
+std::vector<t_c::StopView> GetRouteStops(const t_c::CatalogueReader& db) {
+    std::vector<t_c::StopView> stops;
+    for (const uint32_t stop_id : db.GetStopsByName()) {
+        if (!db.GetStopBuses(stop_id).empty()) {
+            stops.push_back(db.GetStop(stop_id));
         }
-        geographical_length += geo::ComputeDistance(route[i]->coordinates, route[i + 1]->coordinates);
     }
+    return stops;
+}
 
-    double length = 0;
-    for (size_t i = 0; i < route.size(); ++i) {
-        if (i == route.size() - 1) {
-            break;
-        }
-        length += db_.FindDistance(route[i], route[i + 1]);
+void DrawMap(const renderer::MapRenderer& renderer, const t_c::CatalogueReader& db
+            , const std::vector<t_c::StopView>& stops, svg::Document& doc) {
+    renderer.MakeRoadsLayot(db, doc);
+    renderer.MakeBusNamesLayot(db, doc);
+    renderer.MakeCirclesLayot(stops, doc);
+    renderer.MakeStopNamesLayot(stops, doc);
+}
+
+RequestHandler::MapCache& RequestHandler::GetMapCache() const {
+    if (map_cache_.version != db_.GetVersion()) {
+        map_cache_ = MapCache{};
+        map_cache_.version = db_.GetVersion();
     }
+    return map_cache_;
+}
 
-    double curvature = length / geographical_length;
-    return BusStat{bus_name, route_count, unique_count, length, curvature};
+const renderer::SphereProjector& RequestHandler::GetProjector() const {
+    MapCache& cache = GetMapCache();
+    if (!cache.projector) {
+        std::vector<geo::Coordinates> coords;
+        for (const t_c::StopView& stop : GetRouteStops(db_)) {
+            coords.push_back(stop.coordinates);
+        }
+        cache.projector.emplace(coords.begin(), coords.end()
+                                , render_settings_.width
+                                , render_settings_.height
+                                , render_settings_.padding);
+    }
+    return *cache.projector;
 }
 
-std::optional<const std::unordered_set<Bus*>*>
-RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-    const Stop& stop = db_.FindStop(stop_name);
-    if (stop.IsEmpty()) {
-        return std::nullopt;
+const std::string& RequestHandler::RenderMap() const {
+    MapCache& cache = GetMapCache();
+    if (cache.map) {
+        return *cache.map;
     }
-    return &stop.buses;
+
+    const renderer::MapRenderer renderer(render_settings_, GetProjector());
+    svg::Document doc;
+    DrawMap(renderer, db_, GetRouteStops(db_), doc);
+
+    doc.Render(cache.map.emplace());
+    return *cache.map;
 }
 
+const RequestHandler::MapIndex& RequestHandler::GetMapIndex() const {
+    MapCache& cache = GetMapCache();
+    if (cache.index) {
+        return *cache.index;
+    }
 
-std::set<std::string_view> GetBusNames(const std::unordered_map<std::string_view, Bus*>& buses) {
-    std::set<std::string_view> names;
-    for (const auto& [nm, value] : buses) {
-        names.insert(nm);
+    std::vector<t_c::StopIndex::Item> items;
+    for (const t_c::StopView& stop : GetRouteStops(db_)) {
+        items.push_back({stop.coordinates, stop.id, stop.name});
+    }
+    MapIndex& index = cache.index.emplace(MapIndex{t_c::StopIndex(std::move(items))});
+    for (uint32_t bus_id = 0; bus_id < db_.GetBusesCount(); ++bus_id) {
+        const t_c::IdRange route = db_.GetBus(bus_id).route;
+        for (size_t i = 1; i < route.size(); ++i) {
+            const geo::Coordinates from = db_.GetStop(route.begin()[i - 1]).coordinates;
+            const geo::Coordinates to = db_.GetStop(route.begin()[i]).coordinates;
+            index.max_step_lat = std::max(index.max_step_lat, std::abs(to.lat - from.lat));
+            index.max_step_lng = std::max(index.max_step_lng, std::abs(to.lng - from.lng));
+        }
     }
-    return names;
+    return index;
 }
 
-std::vector<Stop*> GetStops(const std::unordered_map<std::string_view, Bus*>& buses
-                            , const std::unordered_map<std::string_view, Stop*>& stops) {
-    std::set<std::string_view> stop_names;
-    for (const auto& [name, bus_ptr] : buses) {
-        for (const auto& stop_ptr : bus_ptr->route) {
-            stop_names.insert(stop_ptr->name);
+bool IntersectsRoute(const t_c::CatalogueReader& db, const t_c::BusView& bus, const geo::Rect& area) {
+    const t_c::IdRange route = bus.route;
+    if (route.size() == 1) {
+        return area.Contains(db.GetStop(*route.begin()).coordinates);
+    }
+    for (size_t i = 1; i < route.size(); ++i) {
+        if (area.IntersectsSegment(db.GetStop(route.begin()[i - 1]).coordinates,
+                                   db.GetStop(route.begin()[i]).coordinates)) {
+            return true;
         }
     }
+    return false;
+}
 
-    std::vector<Stop*> res;
-    res.reserve(stop_names.size());
-    for (const auto& name : stop_names) {
-        res.push_back(stops.at(name));
+std::unordered_set<uint32_t> RequestHandler::FindBuses(const geo::Rect& area) const {
+    const MapIndex& index = GetMapIndex();
+    const geo::Rect candidates_area{
+        area.min_lat - index.max_step_lat, area.min_lng - index.max_step_lng,
+        area.max_lat + index.max_step_lat, area.max_lng + index.max_step_lng
+    };
+
+    std::unordered_set<uint32_t> checked;
+    std::unordered_set<uint32_t> result;
+    for (const uint32_t stop_id : index.stops.FindInRect(candidates_area)) {
+        for (const uint32_t bus_id : db_.GetStopBuses(stop_id)) {
+            if (checked.insert(bus_id).second && IntersectsRoute(db_, db_.GetBus(bus_id), area)) {
+                result.insert(bus_id);
+            }
+        }
     }
+    return result;
+}
 
-    return res;
+// остановки по номерам в порядке возрастания имени
+std::vector<t_c::StopView> GetStopsByName(const t_c::CatalogueReader& db, const std::vector<uint32_t>& stop_ids) {
+    std::vector<t_c::StopView> stops;
+    stops.reserve(stop_ids.size());
+    for (const uint32_t stop_id : stop_ids) {
+        stops.push_back(db.GetStop(stop_id));
+    }
+    std::sort(stops.begin(), stops.end(), [](const t_c::StopView& lhs, const t_c::StopView& rhs) {
+        return lhs.name < rhs.name;
+    });
+    return stops;
 }
 
-void RequestHandler::RenderMap(std::ostream& output) const {
-    const std::unordered_map<std::string_view, Bus*>& buses = db_.GetAllBuses();
-    auto sorted_names = GetBusNames(buses);
-    
+std::string RequestHandler::RenderMap(const geo::Rect& area) const {
+    renderer::MapViewport viewport{area, FindBuses(area)};
+    const std::vector<t_c::StopView> stops = GetStopsByName(db_, GetMapIndex().stops.FindInRect(area));
+
+    const renderer::RenderSettings& settings = render_settings_;
+    const geo::Coordinates corners[] = {{area.min_lat, area.min_lng}, {area.max_lat, area.max_lng}};
+    const renderer::SphereProjector projector{
+        std::begin(corners), std::end(corners)
+        , settings.width
+        , settings.height
+        , settings.padding
+    };
+    const renderer::MapRenderer renderer(settings, projector, &viewport);
+
     svg::Document doc;
-    renderer_.MakeRoadsLayot(buses, sorted_names, doc);
-    renderer_.MakeBusNamesLayot(buses, sorted_names, doc);
+    DrawMap(renderer, db_, stops, doc);
+    std::string result;
+    doc.Render(result);
+    return result;
+}
+
+const std::string* RequestHandler::RenderMapTile(int zoom, int x, int y) const {
+    if (zoom < 0 || zoom > MAX_TILE_ZOOM) {
+        return nullptr;
+    }
+    const int count = 1 << zoom;
+    if (x < 0 || x >= count || y < 0 || y >= count) {
+        return nullptr;
+    }
 
-    const std::unordered_map<std::string_view, Stop*>& stop_ptrs = db_.GetAllStops();
-    const auto stops = GetStops(buses, stop_ptrs);
-    renderer_.MakeCirclesLayot(stops, doc);
-    renderer_.MakeStopNamesLayot(stops, doc);
+    MapCache& cache = GetMapCache();
+    const TileKey key{zoom, x, y};
+    if (const auto it = cache.tile_positions.find(key); it != cache.tile_positions.end()) {
+        cache.tiles.splice(cache.tiles.begin(), cache.tiles, it->second);
+        return &cache.tiles.front().second;
+    }
 
-    doc.Render(output);
+    const geo::Rect& bounds = GetMapIndex().stops.GetBounds();
+    const double lat_step = (bounds.max_lat - bounds.min_lat) / count;
+    const double lng_step = (bounds.max_lng - bounds.min_lng) / count;
+    // верхний ряд плиток - самые северные
+    const geo::Rect area{
+        bounds.max_lat - (y + 1) * lat_step, bounds.min_lng + x * lng_step,
+        bounds.max_lat - y * lat_step, bounds.min_lng + (x + 1) * lng_step
+    };
+    cache.tiles.emplace_front(key, RenderMap(area));
+    cache.tile_positions.emplace(key, cache.tiles.begin());
+    // вытесняется плитка, которую дольше всех не запрашивали
+    if (cache.tiles.size() > MAX_CACHED_TILES) {
+        cache.tile_positions.erase(cache.tiles.back().first);
+        cache.tiles.pop_back();
+    }
+    return &cache.tiles.front().second;
+}
+
+std::vector<t_c::StopIndex::FoundStop> RequestHandler::FindNearestStops(
+                            geo::Coordinates point, size_t count, double radius) const {
+    return db_.GetStopIndex().FindNearest(point, count, radius);
 }
 
-std::optional<graph::Router<double>::RouteInfo> RequestHandler::FindRoute(
+std::vector<t_c::StopView> RequestHandler::FindStopsInArea(const geo::Rect& area) const {
+    return GetStopsByName(db_, db_.GetStopIndex().FindInRect(area));
+}
+
+std::optional<RouteStat> RequestHandler::FindRoute(
                             std::string_view stop_from,
                             std::string_view stop_to) const {
     return router_.FindRoute(stop_from, stop_to);
 }
 
-graph::Edge<double> RequestHandler::GetEdge(int id) const {
-    return router_.GetGraph().GetEdge(id);
+std::optional<RouteStat> RequestHandler::FindRoute(
+                            std::string_view stop_from,
+                            std::string_view stop_to,
+                            double departure_time) const {
+    return router_.FindRoute(stop_from, stop_to, departure_time);
+}
+
+RouteStat RequestHandler::FindRoute(geo::Coordinates from, geo::Coordinates to) const {
+    return router_.FindRoute(from, to);
+}
+
+std::vector<RouteStat> RequestHandler::FindRoutes(
+                            std::string_view stop_from,
+                            std::string_view stop_to,
+                            std::optional<double> departure_time) const {
+    return router_.FindRoutes(stop_from, stop_to, departure_time);
 }
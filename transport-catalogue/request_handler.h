@@ -9,46 +9,121 @@
 #include <string>
 #include <string_view>
 #include <set>
+#include <map>
+#include <list>
+#include <tuple>
 
-#include "transport_catalogue.h"
+#include "catalogue_reader.h"
 #include "transport_router.h"
 #include "map_renderer.h"
 #include "graph.h"
 #include "json.h"
 #include "geo.h"
 #include "svg.h"
+#include "stop_index.h"
 #include "domain.h"
 
 class RequestHandler {
 public:
-    // MapRenderer понадобится в следующей части итогового проекта
+    // проекция и визуализатор карты строятся обработчиком по настройкам отрисовки
     RequestHandler(
-                const t_c::TransportCatalogue& db,
-                const renderer::MapRenderer& renderer,
+                const t_c::CatalogueReader& db,
+                const renderer::RenderSettings& render_settings,
                 const TransportRouter& router
     );
     virtual ~RequestHandler() = default;
 
-    // Возвращает информацию о маршруте (запрос Bus)
+    // Возвращает информацию о маршруте (запрос Bus): справочник считает ее заранее
     std::optional<domain::BusStat> GetBusStat(const std::string_view& bus_name) const;
 
-    // Возвращает маршруты, проходящие через
-    std::optional<const std::unordered_set<domain::Bus*>*>
+    // Возвращает номера маршрутов, проходящих через остановку, по возрастанию имени
+    std::optional<t_c::IdRange>
     GetBusesByStop(const std::string_view& stop_name) const;
 
-    void RenderMap(std::ostream& output) const;
+    // Возвращает svg-карту. Она строится при первом запросе и пересобирается,
+    // только если справочник с тех пор изменился: вместе с ней заново строится и
+    // проекция по остановкам маршрутов
+    const std::string& RenderMap() const;
 
-    std::optional<graph::Router<double>::RouteInfo> FindRoute(
+    // Карта области: маршруты, пересекающие ее, и остановки внутри нее; область
+    // растягивается на весь холст из настроек отрисовки
+    std::string RenderMap(const geo::Rect& area) const;
+
+    // Плитка z/x/y. Нумерация своя, а не Web-Mercator (slippy map): на 2^z x 2^z равных
+    // по широте и долготе частей делится прямоугольник, занятый остановками маршрутов,
+    // x отсчитывается от западного края, y - от северного. Поэтому плитка 0/0/0 - вся
+    // сеть, а номера плиток меняются вместе с этим прямоугольником.
+    // Последние MAX_CACHED_TILES плиток запоминаются; строка действительна до следующего
+    // вызова. Если плитки с такими номерами нет: nullptr
+    const std::string* RenderMapTile(int zoom, int x, int y) const;
+    static constexpr int MAX_TILE_ZOOM = 20;
+    static constexpr size_t MAX_CACHED_TILES = 256;
+
+    // Ближайшие к точке остановки: не больше count и не дальше radius метров
+    std::vector<t_c::StopIndex::FoundStop> FindNearestStops(
+                            geo::Coordinates point, size_t count, double radius) const;
+
+    // Остановки внутри области, по возрастанию имени
+    std::vector<t_c::StopView> FindStopsInArea(const geo::Rect& area) const;
+
+    std::optional<domain::RouteStat> FindRoute(
                             std::string_view stop_from,
                             std::string_view stop_to) const;
 
-    graph::DirectedWeightedGraph<double> GetGraph() const;
+    // Маршрут по расписаниям с отправлением в departure_time
+    std::optional<domain::RouteStat> FindRoute(
+                            std::string_view stop_from,
+                            std::string_view stop_to,
+                            double departure_time) const;
+
+    // Маршрут между точками с переходами пешком к ближайшим остановкам
+    domain::RouteStat FindRoute(geo::Coordinates from, geo::Coordinates to) const;
 
-    graph::Edge<double> GetEdge(int id) const;
+    // Маршруты, оптимальные по числу пересадок и времени: первый - с наименьшим числом
+    // пересадок, последний - самый быстрый. Без departure_time расписания не учитываются
+    std::vector<domain::RouteStat> FindRoutes(
+                            std::string_view stop_from,
+                            std::string_view stop_to,
+                            std::optional<double> departure_time) const;
+
+    // справочник, по которому отвечает обработчик: имена по номерам из ответов
+    const t_c::CatalogueReader& GetCatalogue() const;
 
 private:
     // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-    const t_c::TransportCatalogue& db_;
-    const renderer::MapRenderer& renderer_;
+    const t_c::CatalogueReader& db_;
+    const renderer::RenderSettings& render_settings_;
     const TransportRouter& router_;
+
+    struct MapIndex {
+        t_c::StopIndex stops;
+        // наибольшие разности широт и долгот соседних остановок маршрутов: оба конца отрезка
+        // маршрута, пересекающего область, лежат в ней, расширенной на эти величины
+        double max_step_lat = 0;
+        double max_step_lng = 0;
+    };
+
+    // Производные от справочника данные для карты: строятся по первому запросу
+    // и сбрасываются все сразу, когда справочник изменился
+    using TileKey = std::tuple<int, int, int>;
+    using TileList = std::list<std::pair<TileKey, std::string>>;
+
+    struct MapCache {
+        // версии справочника начинаются с 1
+        uint64_t version = 0;
+        std::optional<renderer::SphereProjector> projector;
+        std::optional<std::string> map;
+        std::optional<MapIndex> index;
+        // плитки от последней запрошенной к самой давней и их места в списке
+        TileList tiles;
+        std::map<TileKey, TileList::iterator> tile_positions;
+    };
+
+    MapCache& GetMapCache() const;
+    // проекция всей карты: область, занятая остановками маршрутов, на холст из настроек
+    const renderer::SphereProjector& GetProjector() const;
+    const MapIndex& GetMapIndex() const;
+    std::unordered_set<uint32_t> FindBuses(const geo::Rect& area) const;
+
+    mutable MapCache map_cache_;
 };
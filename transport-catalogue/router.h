@@ -1,11 +1,14 @@
 #pragma once
 
+#include "binary_io.h"
 #include "graph.h"
+#include "parallel.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -14,104 +17,258 @@
 
 namespace graph {
 
+// Общий интерфейс маршрутизаторов: поиск кратчайшего пути между двумя вершинами графа
 template <typename Weight>
 class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
-
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
 
-private:
-    struct RouteInternalData {
+    // начало или конец пути при поиске с несколькими началами и концами:
+    // вершина и вес, который добавляется к пути, начатому (законченному) в ней
+    struct Terminal {
+        VertexId vertex;
         Weight weight;
-        std::optional<EdgeId> prev_edge;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
-    void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
-                    throw std::domain_error("Edges' weights should be non-negative");
+    // лучший путь: его вес включает веса начала и конца, source и target - их номера
+    struct BestRouteInfo {
+        RouteInfo route;
+        size_t source;
+        size_t target;
+    };
+
+    // Путь наименьшего суммарного веса от одного из начал до одного из концов.
+    // По умолчанию перебирает все пары, маршрутизаторы с поиском по запросу
+    // делают это одним поиском
+    virtual std::optional<BestRouteInfo> BuildBestRoute(const std::vector<Terminal>& sources,
+                                                        const std::vector<Terminal>& targets) const {
+        std::optional<BestRouteInfo> best;
+        for (size_t source = 0; source < sources.size(); ++source) {
+            for (size_t target = 0; target < targets.size(); ++target) {
+                auto route = BuildRoute(sources[source].vertex, targets[target].vertex);
+                if (!route) {
+                    continue;
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                route->weight = sources[source].weight + route->weight + targets[target].weight;
+                if (!best || route->weight < best->route.weight) {
+                    best = BestRouteInfo{std::move(*route), source, target};
                 }
             }
         }
+        return best;
+    }
+
+    // Сохраняет предподсчитанные данные, из которых маршрутизатор восстанавливается
+    // конструктором от графа и потока без повторного предподсчета
+    virtual void Save(std::ostream& output) const = 0;
+
+    virtual ~Router() = default;
+};
+
+// Предподсчитывает кратчайшие пути между всеми парами вершин (Флойд-Уоршелл):
+// O(V^3) на построение и O(V^2) памяти, зато каждый запрос - только восстановление пути.
+// Матрица хранится плоскими массивами весов и последних ребер путей. Промежуточные
+// вершины перебираются по порядку, как в обычном алгоритме, но группами по BLOCK_SIZE:
+// строки группы копируются, и каждая строка матрицы релаксируется через всю группу за
+// один проход, строки - параллельно. Результат, в том числе выбор из путей равного веса,
+// совпадает с обычным Флойдом-Уоршеллом
+template <typename Weight>
+class AllPairsRouter final : public Router<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename Router<Weight>::RouteInfo;
+
+    using typename Router<Weight>::Terminal;
+    using typename Router<Weight>::BestRouteInfo;
+
+    explicit AllPairsRouter(const Graph& graph);
+    AllPairsRouter(const Graph& graph, std::istream& input);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // веса всех пар уже посчитаны: путь восстанавливается только для лучшей
+    std::optional<BestRouteInfo> BuildBestRoute(const std::vector<Terminal>& sources,
+                                                const std::vector<Terminal>& targets) const override;
+
+    void Save(std::ostream& output) const override;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr Weight ZERO_WEIGHT{};
+    // вес недостижимой вершины
+    static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::has_infinity
+                                     ? std::numeric_limits<Weight>::infinity()
+                                     : std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    size_t GetIndex(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    void InitializeRoutesInternalData(const Graph& graph) {
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            weights_[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
+            graph.ForEachIncidentEdge(vertex, [this, vertex](EdgeId edge_id, VertexId to, Weight weight) {
+                if (weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const size_t index = GetIndex(vertex, to);
+                if (weights_[index] > weight) {
+                    weights_[index] = weight;
+                    prev_edges_[index] = edge_id;
+                }
+            });
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Релаксирует строку from через вершины [through_begin, through_end) по очереди.
+    // pivot_weights и pivot_prev_edges - строки этих вершин подряд в том виде, в каком
+    // их видит обычный алгоритм на шаге через каждую из них. Вершина пути through -> to
+    // не совпадает с to, поэтому ее последнее ребро - последнее ребро пути
+    void RelaxRow(VertexId from, VertexId through_begin, VertexId through_end,
+                  const Weight* pivot_weights, const EdgeId* pivot_prev_edges) {
+        Weight* from_weights = &weights_[GetIndex(from, 0)];
+        EdgeId* from_prev_edges = &prev_edges_[GetIndex(from, 0)];
+        for (VertexId through = through_begin; through < through_end; ++through) {
+            // на шаге через through вес from -> through не меняется: путь through -> through пуст
+            const Weight weight_from = from_weights[through];
+            if (weight_from == NO_ROUTE) {
+                continue;
+            }
+            const Weight* through_weights = pivot_weights + (through - through_begin) * vertex_count_;
+            const EdgeId* through_prev_edges = pivot_prev_edges + (through - through_begin) * vertex_count_;
+            for (VertexId to = 0; to < vertex_count_; ++to) {
+                // бесконечность в сумме остается бесконечностью, а max() пришлось бы проверять
+                if constexpr (!std::numeric_limits<Weight>::has_infinity) {
+                    if (through_weights[to] == NO_ROUTE) {
+                        continue;
                     }
                 }
+                const Weight candidate_weight = weight_from + through_weights[to];
+                if (candidate_weight < from_weights[to]) {
+                    from_weights[to] = candidate_weight;
+                    from_prev_edges[to] = through_prev_edges[to];
+                }
             }
         }
     }
 
-    static constexpr Weight ZERO_WEIGHT{};
+    // Для каждой группы промежуточных вершин: сначала по шагам строки самой группы, перед
+    // шагом через вершину ее строка копируется - остальные строки потом релаксируются
+    // через эти копии, независимо друг от друга
+    void RelaxRoutesInternalData() {
+        std::vector<Weight> pivot_weights(BLOCK_SIZE * vertex_count_);
+        std::vector<EdgeId> pivot_prev_edges(BLOCK_SIZE * vertex_count_);
+        for (VertexId through_begin = 0; through_begin < vertex_count_; through_begin += BLOCK_SIZE) {
+            const VertexId through_end = std::min(vertex_count_, through_begin + BLOCK_SIZE);
+            for (VertexId through = through_begin; through < through_end; ++through) {
+                const size_t offset = (through - through_begin) * vertex_count_;
+                std::copy_n(&weights_[GetIndex(through, 0)], vertex_count_, &pivot_weights[offset]);
+                std::copy_n(&prev_edges_[GetIndex(through, 0)], vertex_count_, &pivot_prev_edges[offset]);
+                for (VertexId from = through_begin; from < through_end; ++from) {
+                    RelaxRow(from, through, through + 1, &pivot_weights[offset], &pivot_prev_edges[offset]);
+                }
+            }
+
+            parallel::ForEachIndex(vertex_count_, [&](size_t from) {
+                if (from < through_begin || from >= through_end) {
+                    RelaxRow(from, through_begin, through_end, pivot_weights.data(), pivot_prev_edges.data());
+                }
+            });
+        }
+    }
+
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    const size_t vertex_count_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+AllPairsRouter<Weight>::AllPairsRouter(const Graph& graph)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , weights_(vertex_count_ * vertex_count_, NO_ROUTE)
+    , prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
 {
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalData();
+}
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+template <typename Weight>
+AllPairsRouter<Weight>::AllPairsRouter(const Graph& graph, std::istream& input)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , weights_(binary_io::ReadVector<Weight>(input))
+    , prev_edges_(binary_io::ReadVector<EdgeId>(input))
+{
+    if (weights_.size() != vertex_count_ * vertex_count_ || prev_edges_.size() != weights_.size()) {
+        throw binary_io::ReadError("routes table doesn't match the graph");
     }
 }
 
 template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+void AllPairsRouter<Weight>::Save(std::ostream& output) const {
+    binary_io::WriteVector(output, weights_);
+    binary_io::WriteVector(output, prev_edges_);
+}
+
+template <typename Weight>
+std::optional<typename AllPairsRouter<Weight>::RouteInfo> AllPairsRouter<Weight>::BuildRoute(
+                                                                    VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = weights_[GetIndex(from, to)];
+    if (weight == NO_ROUTE) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (EdgeId edge_id = prev_edges_[GetIndex(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[GetIndex(from, graph_.GetEdge(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
     return RouteInfo{weight, std::move(edges)};
 }
 
-}  // namespace graph
\ No newline at end of file
+template <typename Weight>
+std::optional<typename AllPairsRouter<Weight>::BestRouteInfo> AllPairsRouter<Weight>::BuildBestRoute(
+                                                            const std::vector<Terminal>& sources,
+                                                            const std::vector<Terminal>& targets) const {
+    std::optional<BestRouteInfo> best;
+    for (size_t source = 0; source < sources.size(); ++source) {
+        for (size_t target = 0; target < targets.size(); ++target) {
+            const VertexId from = sources[source].vertex;
+            const VertexId to = targets[target].vertex;
+            if (from >= vertex_count_ || to >= vertex_count_) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            const Weight route_weight = weights_[GetIndex(from, to)];
+            if (route_weight == NO_ROUTE) {
+                continue;
+            }
+            const Weight weight = sources[source].weight + route_weight + targets[target].weight;
+            if (!best || weight < best->route.weight) {
+                best = BestRouteInfo{RouteInfo{weight, {}}, source, target};
+            }
+        }
+    }
+    if (best) {
+        best->route.edges = std::move(BuildRoute(sources[best->source].vertex,
+                                                 targets[best->target].vertex)->edges);
+    }
+    return best;
+}
+
+}  // namespace graph
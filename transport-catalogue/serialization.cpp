@@ -0,0 +1,225 @@
+#include "serialization.h"
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "binary_io.h"
+
+using namespace domain;
+using namespace renderer;
+using namespace t_c;
+using namespace binary_io;
+using namespace std::literals;
+
+namespace serialization {
+
+namespace {
+
+const uint32_t SIGNATURE = 0x42445354; // "TSDB"
+// увеличивается при любом изменении формата
+const uint32_t VERSION = 6;
+// сигнатура, версия и размер образа справочника; образ начинается выровненным на 8 байт
+const size_t PREFIX_SIZE = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+/* ---------------- Render settings ---------------- */
+void SavePoint(std::ostream& output, const svg::Point& point) {
+    Write(output, point.x);
+    Write(output, point.y);
+}
+
+svg::Point LoadPoint(std::istream& input) {
+    const double x = Read<double>(input);
+    const double y = Read<double>(input);
+    return {x, y};
+}
+
+// номер альтернативы варианта, затем ее поля
+void SaveColor(std::ostream& output, const svg::Color& color) {
+    Write<uint8_t>(output, static_cast<uint8_t>(color.index()));
+    if (const auto* str = std::get_if<std::string>(&color)) {
+        WriteString(output, *str);
+    } else if (const auto* rgb = std::get_if<svg::Rgb>(&color)) {
+        Write(output, rgb->red);
+        Write(output, rgb->green);
+        Write(output, rgb->blue);
+    } else if (const auto* rgba = std::get_if<svg::Rgba>(&color)) {
+        Write(output, rgba->red);
+        Write(output, rgba->green);
+        Write(output, rgba->blue);
+        Write(output, rgba->opacity);
+    }
+}
+
+svg::Color LoadColor(std::istream& input) {
+    switch (Read<uint8_t>(input)) {
+        case 0:
+            return std::monostate{};
+        case 1:
+            return ReadString(input);
+        case 2: {
+            const uint8_t red = Read<uint8_t>(input);
+            const uint8_t green = Read<uint8_t>(input);
+            const uint8_t blue = Read<uint8_t>(input);
+            return svg::Rgb(red, green, blue);
+        }
+        case 3: {
+            const uint8_t red = Read<uint8_t>(input);
+            const uint8_t green = Read<uint8_t>(input);
+            const uint8_t blue = Read<uint8_t>(input);
+            return svg::Rgba(red, green, blue, Read<double>(input));
+        }
+    }
+    throw ReadError("color: invalid type");
+}
+
+void SaveRenderSettings(std::ostream& output, const RenderSettings& settings) {
+    Write(output, settings.width);
+    Write(output, settings.height);
+    Write(output, settings.padding);
+    Write(output, settings.line_width);
+    Write(output, settings.stop_radius);
+
+    Write<uint64_t>(output, settings.color_palette.size());
+    for (const svg::Color& color : settings.color_palette) {
+        SaveColor(output, color);
+    }
+
+    Write(output, settings.bus_label_font_size);
+    SavePoint(output, settings.bus_label_offset);
+    Write(output, settings.stop_label_font_size);
+    SavePoint(output, settings.stop_label_offset);
+    SaveColor(output, settings.underlayer_color);
+    Write(output, settings.underlayer_width);
+}
+
+void LoadRenderSettings(std::istream& input, RenderSettings& settings) {
+    settings.width = Read<double>(input);
+    settings.height = Read<double>(input);
+    settings.padding = Read<double>(input);
+    settings.line_width = Read<double>(input);
+    settings.stop_radius = Read<double>(input);
+
+    // каждый цвет занимает хотя бы байт
+    settings.color_palette.resize(ReadLength(input, 1));
+    for (svg::Color& color : settings.color_palette) {
+        color = LoadColor(input);
+    }
+
+    settings.bus_label_font_size = Read<uint32_t>(input);
+    settings.bus_label_offset = LoadPoint(input);
+    settings.stop_label_font_size = Read<uint32_t>(input);
+    settings.stop_label_offset = LoadPoint(input);
+    settings.underlayer_color = LoadColor(input);
+    settings.underlayer_width = Read<double>(input);
+}
+
+/* ---------------- Routing settings ---------------- */
+void SaveRoutingSettings(std::ostream& output, const RoutingSettings& settings) {
+    Write(output, settings.wait_time);
+    Write(output, settings.velocity);
+    Write<uint8_t>(output, static_cast<uint8_t>(settings.router_mode));
+    Write(output, settings.walk_velocity);
+    Write<int32_t>(output, settings.walk_stops_count);
+}
+
+RoutingSettings LoadRoutingSettings(std::istream& input) {
+    RoutingSettings settings;
+    settings.wait_time = Read<double>(input);
+    settings.velocity = Read<double>(input);
+    const uint8_t mode = Read<uint8_t>(input);
+    if (mode > static_cast<uint8_t>(RouterMode::RAPTOR)) {
+        throw ReadError("wrong router mode");
+    }
+    settings.router_mode = static_cast<RouterMode>(mode);
+    settings.walk_velocity = Read<double>(input);
+    settings.walk_stops_count = Read<int32_t>(input);
+    return settings;
+}
+
+} // namespace
+
+void SaveBase(std::ostream& output
+            , const TransportCatalogue& catalogue
+            , const RenderSettings& render_settings
+            , const TransportRouter& router) {
+    const std::vector<uint64_t> image = t_c::MakeCatalogueImage(catalogue);
+    Write(output, SIGNATURE);
+    Write(output, VERSION);
+    Write<uint64_t>(output, image.size() * sizeof(uint64_t));
+    output.write(reinterpret_cast<const char*>(image.data()), image.size() * sizeof(uint64_t));
+    SaveRenderSettings(output, render_settings);
+    SaveRoutingSettings(output, router.GetRoutingSettings());
+    router.Save(output);
+}
+
+/* ---------------- BaseSnapshot ---------------- */
+BaseSnapshot::BaseSnapshot(const std::string& file) {
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can't open "s + file);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < PREFIX_SIZE) {
+        close(fd);
+        throw ReadError("not a transport catalogue base");
+    }
+    size_ = file_stat.st_size;
+    void* const data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("can't map "s + file);
+    }
+    data_ = static_cast<const char*>(data);
+
+    try {
+        MemoryBuffer buffer(data_, data_ + size_);
+        std::istream input(&buffer);
+        if (Read<uint32_t>(input) != SIGNATURE) {
+            throw ReadError("not a transport catalogue base");
+        }
+        if (Read<uint32_t>(input) != VERSION) {
+            throw ReadError("unsupported base version");
+        }
+        const uint64_t image_size = Read<uint64_t>(input);
+        if (image_size > size_ - PREFIX_SIZE) {
+            throw ReadError("catalogue image is truncated");
+        }
+        catalogue_.emplace(data_ + PREFIX_SIZE, image_size);
+        settings_offset_ = PREFIX_SIZE + image_size;
+    } catch (...) {
+        Unmap();
+        throw;
+    }
+}
+
+BaseSnapshot::~BaseSnapshot() {
+    Unmap();
+}
+
+void BaseSnapshot::Unmap() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+    }
+}
+
+const t_c::CatalogueView& BaseSnapshot::GetCatalogue() const {
+    return *catalogue_;
+}
+
+std::unique_ptr<TransportRouter> BaseSnapshot::LoadRouter(RenderSettings& render_settings) const {
+    MemoryBuffer buffer(data_ + settings_offset_, data_ + size_);
+    std::istream input(&buffer);
+    LoadRenderSettings(input, render_settings);
+    RoutingSettings routing_settings = LoadRoutingSettings(input);
+    return std::make_unique<TransportRouter>(std::move(routing_settings), *catalogue_, input);
+}
+
+} // serialization
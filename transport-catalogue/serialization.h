@@ -0,0 +1,49 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "catalogue_view.h"
+#include "domain.h"
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+// Снимок базы: справочник, настройки отрисовки и маршрутизации и построенный маршрутизатор.
+// Формат двоичный и зависит от платформы; снимок начинается с сигнатуры и номера версии,
+// снимок другой версии не загружается. Справочник лежит сразу за ними плоским образом
+// (см. catalogue_view.h), который читается на месте после отображения файла в память
+namespace serialization {
+
+void SaveBase(std::ostream& output
+            , const t_c::TransportCatalogue& catalogue
+            , const renderer::RenderSettings& render_settings
+            , const TransportRouter& router);
+
+// Файл снимка, отображенный в память только для чтения
+class BaseSnapshot {
+public:
+    explicit BaseSnapshot(const std::string& file);
+    BaseSnapshot(const BaseSnapshot&) = delete;
+    BaseSnapshot& operator=(const BaseSnapshot&) = delete;
+    ~BaseSnapshot();
+
+    // справочник без копирования; действителен, пока жив снимок
+    const t_c::CatalogueView& GetCatalogue() const;
+
+    // Заполняет настройки отрисовки и возвращает маршрутизатор по справочнику снимка;
+    // маршрутизатор действителен, пока жив снимок
+    std::unique_ptr<TransportRouter> LoadRouter(renderer::RenderSettings& render_settings) const;
+
+private:
+    void Unmap();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::optional<t_c::CatalogueView> catalogue_;
+    // начало данных, следующих за образом справочника
+    size_t settings_offset_ = 0;
+};
+
+} // serialization
@@ -0,0 +1,166 @@
+#include "stop_index.h"
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace t_c {
+
+namespace {
+
+double GetKey(geo::Coordinates coordinates, bool by_lat) {
+    return by_lat ? coordinates.lat : coordinates.lng;
+}
+
+// Нижняя оценка расстояния от точки до любой точки по другую сторону от широты или
+// долготы key: вдоль меридиана или до большого круга меридиана соответственно.
+// geo::ComputeDistance считает через acos и на малых расстояниях ошибается на доли метра,
+// поэтому оценка уменьшена на метр, чтобы не отсечь подходящую остановку
+double GetDistanceBound(geo::Coordinates point, double key, bool by_lat) {
+    const double RADIUS_OF_EARTH = 6371000;
+    const double MARGIN = 1;
+    const double dr = M_PI / 180.0;
+    double angle = 0;
+    if (by_lat) {
+        angle = std::abs(point.lat - key) * dr;
+    } else if (const double d_lng = std::abs(point.lng - key) * dr; d_lng < M_PI / 2) {
+        angle = std::asin(std::min(1.0, std::cos(point.lat * dr) * std::sin(d_lng)));
+    }
+    return std::max(0.0, angle * RADIUS_OF_EARTH - MARGIN);
+}
+
+bool IsCloser(const StopIndex::FoundStop& lhs, const StopIndex::FoundStop& rhs) {
+    if (lhs.distance != rhs.distance) {
+        return lhs.distance < rhs.distance;
+    }
+    return lhs.name < rhs.name;
+}
+
+} // namespace
+
+StopIndex::StopIndex(std::vector<Item> items)
+    : items_(std::move(items)) {
+    if (items_.empty()) {
+        return;
+    }
+
+    const geo::Coordinates first = items_.front().coordinates;
+    bounds_ = {first.lat, first.lng, first.lat, first.lng};
+    for (const Item& item : items_) {
+        bounds_.min_lat = std::min(bounds_.min_lat, item.coordinates.lat);
+        bounds_.min_lng = std::min(bounds_.min_lng, item.coordinates.lng);
+        bounds_.max_lat = std::max(bounds_.max_lat, item.coordinates.lat);
+        bounds_.max_lng = std::max(bounds_.max_lng, item.coordinates.lng);
+    }
+    Build(0, items_.size(), true);
+}
+
+void StopIndex::Build(size_t begin, size_t end, bool by_lat) {
+    if (end - begin <= 1) {
+        return;
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    std::nth_element(items_.begin() + begin, items_.begin() + mid, items_.begin() + end,
+        [by_lat](const Item& lhs, const Item& rhs) {
+            return GetKey(lhs.coordinates, by_lat) < GetKey(rhs.coordinates, by_lat);
+        });
+    Build(begin, mid, !by_lat);
+    Build(mid + 1, end, !by_lat);
+}
+
+std::vector<uint32_t> StopIndex::FindInRect(const geo::Rect& area) const {
+    std::vector<uint32_t> result;
+    FindInRect(0, items_.size(), true, area, result);
+    return result;
+}
+
+void StopIndex::FindInRect(size_t begin, size_t end, bool by_lat, const geo::Rect& area
+                            , std::vector<uint32_t>& result) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    const Item& item = items_[mid];
+    if (area.Contains(item.coordinates)) {
+        result.push_back(item.id);
+    }
+
+    // слева от медианы ключи не больше ее ключа, справа - не меньше
+    const double key = GetKey(item.coordinates, by_lat);
+    if ((by_lat ? area.min_lat : area.min_lng) <= key) {
+        FindInRect(begin, mid, !by_lat, area, result);
+    }
+    if (key <= (by_lat ? area.max_lat : area.max_lng)) {
+        FindInRect(mid + 1, end, !by_lat, area, result);
+    }
+}
+
+// Найденные остановки хранятся кучей с самой дальней наверху, пока их не больше count
+struct StopIndex::NearestSearch {
+    geo::Coordinates point;
+    size_t count;
+    double radius;
+    std::vector<FoundStop> found;
+
+    // дальше этого расстояния остановки уже не подходят
+    double GetLimit() const {
+        return found.size() < count ? radius : found.front().distance;
+    }
+
+    void Offer(const FoundStop& candidate) {
+        if (candidate.distance > radius) {
+            return;
+        }
+        if (found.size() < count) {
+            found.push_back(candidate);
+            std::push_heap(found.begin(), found.end(), IsCloser);
+        } else if (IsCloser(candidate, found.front())) {
+            std::pop_heap(found.begin(), found.end(), IsCloser);
+            found.back() = candidate;
+            std::push_heap(found.begin(), found.end(), IsCloser);
+        }
+    }
+};
+
+std::vector<StopIndex::FoundStop> StopIndex::FindNearest(geo::Coordinates point
+                                                        , size_t count, double radius) const {
+    NearestSearch search{point, count, radius, {}};
+    if (count > 0) {
+        FindNearest(0, items_.size(), true, search);
+    }
+    std::sort_heap(search.found.begin(), search.found.end(), IsCloser);
+    return std::move(search.found);
+}
+
+void StopIndex::FindNearest(size_t begin, size_t end, bool by_lat, NearestSearch& search) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    const Item& item = items_[mid];
+    search.Offer({item.id, item.name, geo::ComputeDistance(search.point, item.coordinates)});
+
+    // сначала половина с точкой, затем другая - если до нее ближе найденного
+    const double key = GetKey(item.coordinates, by_lat);
+    const bool is_left = GetKey(search.point, by_lat) < key;
+    const size_t near_begin = is_left ? begin : mid + 1;
+    const size_t near_end = is_left ? mid : end;
+    const size_t far_begin = is_left ? mid + 1 : begin;
+    const size_t far_end = is_left ? end : mid;
+
+    FindNearest(near_begin, near_end, !by_lat, search);
+    if (GetDistanceBound(search.point, key, by_lat) <= search.GetLimit()) {
+        FindNearest(far_begin, far_end, !by_lat, search);
+    }
+}
+
+const geo::Rect& StopIndex::GetBounds() const {
+    return bounds_;
+}
+
+size_t StopIndex::GetSize() const {
+    return items_.size();
+}
+
+} // t_c
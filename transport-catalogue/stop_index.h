@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "geo.h"
+
+namespace t_c {
+
+// Статическое k-d дерево по координатам остановок. Узлы лежат в одном массиве: корень
+// поддерева - медиана своего отрезка, уровни дерева чередуют широту и долготу
+class StopIndex {
+public:
+    // остановка: координаты, номер в справочнике и имя
+    struct Item {
+        geo::Coordinates coordinates;
+        uint32_t id;
+        std::string_view name;
+    };
+
+    struct FoundStop {
+        uint32_t id;
+        std::string_view name;
+        // расстояние по поверхности Земли в метрах, как у geo::ComputeDistance
+        double distance;
+    };
+
+    explicit StopIndex(std::vector<Item> items);
+
+    // номера остановок внутри области (включая границу), в порядке обхода дерева
+    std::vector<uint32_t> FindInRect(const geo::Rect& area) const;
+
+    // Не больше count ближайших к точке остановок не дальше radius метров,
+    // по возрастанию расстояния (при равенстве - по имени)
+    std::vector<FoundStop> FindNearest(geo::Coordinates point
+                                    , size_t count = std::numeric_limits<size_t>::max()
+                                    , double radius = std::numeric_limits<double>::infinity()) const;
+
+    // наименьшая область, содержащая все остановки; для пустого индекса - нулевая
+    const geo::Rect& GetBounds() const;
+    size_t GetSize() const;
+
+private:
+    void Build(size_t begin, size_t end, bool by_lat);
+    void FindInRect(size_t begin, size_t end, bool by_lat, const geo::Rect& area
+                    , std::vector<uint32_t>& result) const;
+
+    struct NearestSearch;
+    void FindNearest(size_t begin, size_t end, bool by_lat, NearestSearch& search) const;
+
+    std::vector<Item> items_;
+    geo::Rect bounds_;
+};
+
+} // t_c
@@ -10,21 +10,50 @@ void Object::Render(const RenderContext& context) const {
     // Делегируем вывод тега своим подклассам
     RenderObject(context);
 
-    context.out << std::endl;
+    context.out.push_back('\n');
 }
 
 void Document::AddPtr(std::unique_ptr<Object>&& obj) {
-    obj_pointers_.emplace_back(std::move(obj));
+    elements_.emplace_back(std::move(obj));
 }
 
-void Document::Render(std::ostream& out) const {
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n";
+size_t Document::EstimateSize() const {
+    // заголовок и закрывающий тег, по тегу на элемент и по вершине на каждую точку ломаной
+    size_t size = 128;
+    for (const Element& element : elements_) {
+        size += 192;
+        if (const auto* polyline = std::get_if<Polyline>(&element)) {
+            size += polyline->points_.size() * 24;
+        }
+    }
+    return size;
+}
+
+void Document::Render(std::string& out) const {
+    out.reserve(out.size() + EstimateSize());
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out += "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
     RenderContext context(out, 0, 2);
-    for (const auto& ptr : obj_pointers_) {
-        ptr->Render(context);
+    for (const Element& element : elements_) {
+        std::visit([&context](const auto& obj) {
+            using Obj = std::decay_t<decltype(obj)>;
+            if constexpr (std::is_same_v<Obj, std::unique_ptr<Object>>) {
+                obj->Render(context);
+            } else {
+                // классы элементов final, поэтому RenderObject вызывается напрямую
+                context.RenderIndent();
+                obj.RenderObject(context);
+                context.out.push_back('\n');
+            }
+        }, element);
     }
-    out << "</svg>";
+    out += "</svg>"sv;
+}
+
+void Document::Render(std::ostream& out) const {
+    std::string text;
+    Render(text);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
 }
 
 
@@ -32,10 +61,15 @@ void Document::Render(std::ostream& out) const {
 
 void Circle::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\""sv;
+    out += "<circle cx=\""sv;
+    number_format::Append(out, center_.x);
+    out += "\" cy=\""sv;
+    number_format::Append(out, center_.y);
+    out += "\" r=\""sv;
+    number_format::Append(out, radius_);
+    out.push_back('"');
     this->RenderAttrs(out);
-    out << "/>"sv;
+    out += "/>"sv;
 }
 
 Circle& Circle::SetCenter(Point center)  {
@@ -53,18 +87,20 @@ Circle& Circle::SetRadius(double radius)  {
 
 void Polyline::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<polyline points=\""sv;
+    out += "<polyline points=\""sv;
     bool is_first = true;
     for (const Point& point : points_) {
         if (!is_first) {
-            out << " "sv;
+            out.push_back(' ');
         }
         is_first = false;
-        out << point.x << ","sv << point.y;
+        number_format::Append(out, point.x);
+        out.push_back(',');
+        number_format::Append(out, point.y);
     }
-    out << "\""sv;
+    out.push_back('"');
     this->RenderAttrs(out);
-    out << "/>"sv;
+    out += "/>"sv;
 }
 
 Polyline& Polyline::AddPoint(Point point) {
@@ -76,20 +112,31 @@ Polyline& Polyline::AddPoint(Point point) {
 
 void Text::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<text"sv;
-    out << " x=\""sv << pos_.x << "\""sv << " y=\""sv << pos_.y << "\""sv;
-    out << " dx=\""sv << offset_.x << "\""sv << " dy=\""sv << offset_.y << "\""sv;
-    out << " font-size=\""sv << size_ << "\""sv;
+    out += "<text x=\""sv;
+    number_format::Append(out, pos_.x);
+    out += "\" y=\""sv;
+    number_format::Append(out, pos_.y);
+    out += "\" dx=\""sv;
+    number_format::Append(out, offset_.x);
+    out += "\" dy=\""sv;
+    number_format::Append(out, offset_.y);
+    out += "\" font-size=\""sv;
+    number_format::Append(out, size_);
+    out.push_back('"');
     if (font_family_ != "") {
-        out << " font-family=\""sv << font_family_ << "\""sv;
+        out += " font-family=\""sv;
+        out += font_family_;
+        out.push_back('"');
     }
     if (font_weight_ != "") {
-        out << " font-weight=\""sv << font_weight_ << "\""sv;
+        out += " font-weight=\""sv;
+        out += font_weight_;
+        out.push_back('"');
     }
     this->RenderAttrs(out);
-    out << ">"sv;
-    out << data_;
-    out << "</text>"sv;
+    out.push_back('>');
+    out += data_;
+    out += "</text>"sv;
 }
 
 Text& Text::SetPosition(Point pos) {
@@ -3,14 +3,17 @@
 #include <cstdint>
 #include <deque>
 #include <iostream>
+#include <string_view>
+#include <type_traits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <variant>
 #include <vector>
-#include <sstream>
 #include <string>
 
+#include "number_format.h"
+
 namespace svg {
 
 using namespace std::literals;
@@ -66,50 +69,64 @@ enum class StrokeLineJoin {
     ROUND,
 };
 
-inline std::ostream& operator<<(std::ostream& out, const StrokeLineCap& linecap) {
-    if (linecap == StrokeLineCap::BUTT) {
-        out << "butt"sv;
-    } else if (linecap == StrokeLineCap::ROUND) {
-        out << "round"sv;
-    } else if (linecap == StrokeLineCap::SQUARE) {
-        out << "square"sv;
+inline std::string_view ToString(StrokeLineCap linecap) {
+    switch (linecap) {
+        case StrokeLineCap::BUTT:
+            return "butt"sv;
+        case StrokeLineCap::ROUND:
+            return "round"sv;
+        case StrokeLineCap::SQUARE:
+            return "square"sv;
     }
-    return out;
+    return {};
 }
 
-inline std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& linejoin) {
-    if (linejoin == StrokeLineJoin::MITER) {
-        out << "miter"sv;
-    } else if (linejoin == StrokeLineJoin::MITER_CLIP) {
-        out << "miter-clip"sv;
-    } else if (linejoin == StrokeLineJoin::ROUND) {
-        out << "round"sv;
-    } else if (linejoin == StrokeLineJoin::BEVEL) {
-        out << "bevel"sv;
-    } else if (linejoin == StrokeLineJoin::ARCS) {
-        out << "arcs"sv;
+inline std::string_view ToString(StrokeLineJoin linejoin) {
+    switch (linejoin) {
+        case StrokeLineJoin::MITER:
+            return "miter"sv;
+        case StrokeLineJoin::MITER_CLIP:
+            return "miter-clip"sv;
+        case StrokeLineJoin::ROUND:
+            return "round"sv;
+        case StrokeLineJoin::BEVEL:
+            return "bevel"sv;
+        case StrokeLineJoin::ARCS:
+            return "arcs"sv;
     }
-    return out;
+    return {};
 }
 
+// Дописывает цвет в конец строки
 struct ColorPrint {
-    std::ostream& out;
+    std::string& out;
 
-    void operator()(std::monostate) const { out << svg::NoneColor; } 
-    void operator()(std::string str) const { out << str; }
+    void operator()(std::monostate) const { out += svg::NoneColor; }
+    void operator()(const std::string& str) const { out += str; }
     void operator()(svg::Rgb rgb) const {
-        out << "rgb("sv << (int)rgb.red << ","sv << (int)rgb.green 
-        << ","sv << (int)rgb.blue << ")"sv;
+        out += "rgb("sv;
+        number_format::Append(out, int{rgb.red});
+        out.push_back(',');
+        number_format::Append(out, int{rgb.green});
+        out.push_back(',');
+        number_format::Append(out, int{rgb.blue});
+        out.push_back(')');
     }
     void operator()(svg::Rgba rgba) const {
-        out << "rgba("sv << (int)rgba.red << ","sv << (int)rgba.green << ","sv 
-        << (int)rgba.blue << ","sv << rgba.opacity << ")"sv;
+        out += "rgba("sv;
+        number_format::Append(out, int{rgba.red});
+        out.push_back(',');
+        number_format::Append(out, int{rgba.green});
+        out.push_back(',');
+        number_format::Append(out, int{rgba.blue});
+        out.push_back(',');
+        number_format::Append(out, rgba.opacity);
+        out.push_back(')');
     }
 };
 
-inline std::ostream& operator<<(std::ostream& out, const Color& color) {
+inline void AppendColor(std::string& out, const Color& color) {
     std::visit(ColorPrint{out}, color);
-    return out;
 }
 
 template <typename Owner>
@@ -139,24 +156,34 @@ public:
 protected:
     ~PathProps() = default;
 
-    // Метод RenderAttrs выводит в поток общие для всех путей атрибуты fill и stroke
-    void RenderAttrs(std::ostream& out) const {
+    // Метод RenderAttrs дописывает в строку общие для всех путей атрибуты fill и stroke
+    void RenderAttrs(std::string& out) const {
         using namespace std::literals;
 
         if (fill_color_) {
-            out << " fill=\""sv << *fill_color_ << "\""sv;
+            out += " fill=\""sv;
+            AppendColor(out, *fill_color_);
+            out.push_back('"');
         }
         if (stroke_color_) {
-            out << " stroke=\""sv << *stroke_color_ << "\""sv;
+            out += " stroke=\""sv;
+            AppendColor(out, *stroke_color_);
+            out.push_back('"');
         }
         if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
+            out += " stroke-width=\""sv;
+            number_format::Append(out, *stroke_width_);
+            out.push_back('"');
         }
         if (stroke_linecap_) {
-            out << " stroke-linecap=\""sv << *stroke_linecap_ << "\""sv;
+            out += " stroke-linecap=\""sv;
+            out += ToString(*stroke_linecap_);
+            out.push_back('"');
         }
         if (stroke_linejoin_) {
-            out << " stroke-linejoin=\""sv << *stroke_linejoin_ << "\""sv;
+            out += " stroke-linejoin=\""sv;
+            out += ToString(*stroke_linejoin_);
+            out.push_back('"');
         }
     }
 
@@ -177,14 +204,14 @@ private:
 
 /*
  * Вспомогательная структура, хранящая контекст для вывода SVG-документа с отступами.
- * Хранит ссылку на поток вывода, текущее значение и шаг отступа при выводе элемента
+ * Хранит ссылку на строку-буфер вывода, текущее значение и шаг отступа при выводе элемента
  */
 struct RenderContext {
-    RenderContext(std::ostream& out)
+    RenderContext(std::string& out)
         : out(out) {
     }
 
-    RenderContext(std::ostream& out, int indent_step, int indent = 0)
+    RenderContext(std::string& out, int indent_step, int indent = 0)
         : out(out)
         , indent_step(indent_step)
         , indent(indent) {
@@ -195,12 +222,10 @@ struct RenderContext {
     }
 
     void RenderIndent() const {
-        for (int i = 0; i < indent; ++i) {
-            out.put(' ');
-        }
+        out.append(static_cast<size_t>(indent), ' ');
     }
 
-    std::ostream& out;
+    std::string& out;
     int indent_step = 0;
     int indent = 0;
 };
@@ -238,23 +263,6 @@ public:
     virtual ~Drawable() = default;
 };
 
-class Document : public ObjectContainer {
-public:
-
-    Document() = default;
-
-    // Добавляет в svg-документ объект-наследник svg::Object
-    void AddPtr(std::unique_ptr<Object>&& obj) override;
-
-    // Выводит в ostream svg-представление документа
-    void Render(std::ostream& out) const;
-
-    virtual ~Document() = default;
-
-private:
-    std::deque<std::unique_ptr<Object>> obj_pointers_;
-};
-
 /*
  * Класс Circle моделирует элемент <circle> для отображения круга
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/circle
@@ -266,6 +274,7 @@ public:
     Circle& SetRadius(double radius);
 
 private:
+    friend class Document;
     void RenderObject(const RenderContext& context) const override;
 
     Point center_;
@@ -276,22 +285,23 @@ private:
  * Класс Polyline моделирует элемент <polyline> для отображения ломаных линий
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/polyline
  */
-class Polyline : public Object, public PathProps<Polyline>  {
+class Polyline final : public Object, public PathProps<Polyline> {
 public:
     Polyline() = default;
     // Добавляет очередную вершину к ломаной линии
     Polyline& AddPoint(Point point);
 
 private:
+    friend class Document;
     void RenderObject(const RenderContext& context) const override;
-    std::deque<Point> points_;
+    std::vector<Point> points_;
 };
 
 /*
  * Класс Text моделирует элемент <text> для отображения текста
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/text
  */
-class Text : public Object, public PathProps<Text> {
+class Text final : public Object, public PathProps<Text> {
 public:
     // Задаёт координаты опорной точки (атрибуты x и y)
     Text() = default;
@@ -314,6 +324,7 @@ public:
     Text& SetData(std::string data);
 
 private:
+    friend class Document;
     void RenderObject(const RenderContext& context) const override;
     Point pos_;
     Point offset_;
@@ -324,4 +335,42 @@ private:
     // Прочие данные и методы, необходимые для реализации элемента <text>
 };
 
+/*
+ * Элементы, которые знает сам документ, хранятся по значению и выводятся без виртуальных
+ * вызовов; прочие наследники svg::Object - через указатель
+ */
+using Element = std::variant<Circle, Polyline, Text, std::unique_ptr<Object>>;
+
+class Document : public ObjectContainer {
+public:
+
+    Document() = default;
+
+    template <typename Obj>
+    void Add(Obj obj) {
+        if constexpr (std::is_constructible_v<Element, Obj&&>) {
+            elements_.emplace_back(std::move(obj));
+        } else {
+            AddPtr(std::make_unique<Obj>(std::move(obj)));
+        }
+    }
+
+    // Добавляет в svg-документ объект-наследник svg::Object
+    void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+    // Дописывает svg-представление документа в конец строки, заранее резервируя место
+    void Render(std::string& out) const;
+    // Выводит в ostream svg-представление документа
+    void Render(std::ostream& out) const;
+
+    virtual ~Document() = default;
+
+private:
+    // примерный размер svg-представления, чтобы вывод обошелся одним выделением памяти
+    size_t EstimateSize() const;
+
+    std::deque<Element> elements_;
+};
+
+
 }  // namespace svg
\ No newline at end of file
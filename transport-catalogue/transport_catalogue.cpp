@@ -1,22 +1,119 @@
 #include "transport_catalogue.h"
 
+#include <limits>
+#include <mutex>
+
+#include "parallel.h"
+
 using namespace domain;
  
 namespace t_c {
 
+namespace {
+
+template <typename Items>
+std::vector<uint32_t> SortIdsByName(const Items& items) {
+    std::vector<uint32_t> ids(items.size());
+    for (uint32_t id = 0; id < ids.size(); ++id) {
+        ids[id] = id;
+    }
+    std::sort(ids.begin(), ids.end(), [&items](uint32_t lhs, uint32_t rhs) {
+        return items[lhs].name < items[rhs].name;
+    });
+    return ids;
+}
+
+IdRange MakeIdRange(const std::vector<uint32_t>& ids) {
+    return {ids.data(), ids.data() + ids.size()};
+}
+
+} // namespace
+
 struct TransportCatalogue::Impl {
     Impl() = default;
     Impl(const Impl& other)
         : stops_(other.stops_), stopname_to_stop_(other.stopname_to_stop_)
         , buses_(other.buses_), busname_to_bus_(other.busname_to_bus_)
-        , distances_(other.distances_) {
+        , route_begins_(other.route_begins_), route_stops_(other.route_stops_)
+        , route_road_(other.route_road_), route_reverse_road_(other.route_reverse_road_)
+        , route_geo_(other.route_geo_), distances_(other.distances_) {
+    }
+
+    // номер следующего добавляемого элемента; номера должны помещаться в uint32_t
+    static uint32_t NextId(size_t count) {
+        if (count >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("too many catalogue items");
+        }
+        return static_cast<uint32_t>(count);
     }
 
     std::deque<Stop> stops_;
     std::unordered_map<std::string_view, Stop*> stopname_to_stop_;
     std::deque<Bus> buses_;
     std::unordered_map<std::string_view, Bus*> busname_to_bus_;
-    std::unordered_map<std::pair<Stop*, Stop*>, double, DistanceHasher> distances_;
+    // номера остановок маршрутов подряд: маршрут автобуса id - [route_begins_[id], route_begins_[id + 1])
+    std::vector<uint32_t> route_begins_{0};
+    std::vector<uint32_t> route_stops_;
+    // длины маршрутов нарастающим итогом, по тем же позициям, что и route_stops_
+    std::vector<double> route_road_;
+    std::vector<double> route_reverse_road_;
+    std::vector<double> route_geo_;
+    DistanceTable distances_;
+    // копия получает собственную версию
+    uint64_t version_ = NextCatalogueVersion();
+
+    std::unique_ptr<StopIndex> stop_index_;
+    std::mutex stop_index_mutex_;
+
+    // номера остановок и автобусов по возрастанию имени
+    struct NameOrder {
+        std::vector<uint32_t> stops;
+        std::vector<uint32_t> buses;
+    };
+    std::unique_ptr<NameOrder> name_order_;
+    std::mutex name_order_mutex_;
+
+    // номера автобусов всех остановок подряд: у остановки id - [offsets[id], offsets[id + 1])
+    struct StopBuses {
+        std::vector<uint32_t> buses;
+        std::vector<uint32_t> offsets;
+    };
+    std::unique_ptr<StopBuses> stop_buses_;
+    std::mutex stop_buses_mutex_;
+
+    // статистика по номеру автобуса
+    using BusStats = std::vector<BusStat>;
+    std::unique_ptr<BusStats> bus_stats_;
+    std::mutex bus_stats_mutex_;
+
+    // дорожные длины маршрута автобуса id нарастающим итогом по текущим расстояниям
+    void FillRoadLengths(uint32_t id) {
+        const std::vector<Stop*>& route = buses_[id].route;
+        const uint32_t begin = route_begins_[id];
+        for (size_t i = 1; i < route.size(); ++i) {
+            const uint32_t from = route[i - 1]->id;
+            const uint32_t to = route[i]->id;
+            route_road_[begin + i] = route_road_[begin + i - 1] + distances_.Find(from, to);
+            route_reverse_road_[begin + i] = route_reverse_road_[begin + i - 1] + distances_.Find(to, from);
+        }
+    }
+
+    // упорядочения остановок и автобусов строятся вместе
+    const NameOrder& GetNameOrder() {
+        std::lock_guard guard(name_order_mutex_);
+        if (!name_order_) {
+            name_order_ = std::make_unique<NameOrder>(NameOrder{SortIdsByName(stops_), SortIdsByName(buses_)});
+        }
+        return *name_order_;
+    }
+
+    // после изменения справочника производные данные строятся заново
+    void Change() {
+        version_ = NextCatalogueVersion();
+        name_order_.reset();
+        stop_buses_.reset();
+        bus_stats_.reset();
+    }
 };
 
 
@@ -45,28 +142,45 @@ TransportCatalogue::~TransportCatalogue() = default;
 
 /* ---------------- Distances ---------------- */
 void TransportCatalogue::AddDistance(Stop* from_stop, Stop* to_stop, const double distance) {
-    impl_->distances_[{from_stop, to_stop}] = std::move(distance);
+    // у пустой остановки (не найденной по имени) номера нет
+    if (from_stop->IsEmpty() || to_stop->IsEmpty()) {
+        return;
+    }
+    impl_->distances_.Add(from_stop->id, to_stop->id, distance);
+    // пересчитываются только автобусы через from_stop; обычно расстояния задаются
+    // до автобусов, и пересчитывать нечего
+    for (const Bus* bus : from_stop->buses) {
+        impl_->FillRoadLengths(bus->id);
+    }
+    impl_->Change();
+}
+
+void TransportCatalogue::ReserveDistances(size_t count) {
+    impl_->distances_.Reserve(count);
 }
 
-// указанное расстояние double между двумя остановками. Если не найдено: -1
 double TransportCatalogue::FindDistance(Stop* first, Stop* second) const {
-    auto distance = impl_->distances_.find({first, second});
-    if (distance != impl_->distances_.end()) {
-        return distance->second;
-    }
-    auto reverse_distance = impl_->distances_.find({second, first});
-    if (reverse_distance != impl_->distances_.end()) {
-        return reverse_distance->second;
-    }
-    return -1;
+    return FindDistance(first->id, second->id);
+}
+
+double TransportCatalogue::FindDistance(uint32_t from_id, uint32_t to_id) const {
+    return impl_->distances_.Find(from_id, to_id);
+}
+
+const DistanceTable& TransportCatalogue::GetDistances() const {
+    return impl_->distances_;
 }
 
 /* ---------------- Stops ---------------- */
 void TransportCatalogue::AddStop(const Stop& stop) {
+    const uint32_t id = Impl::NextId(impl_->stops_.size());
     impl_->stops_.push_back(std::move(stop));
     size_t index = impl_->stops_.size() - 1u;
     Stop* curr_stop_ptr = &impl_->stops_[index];
+    curr_stop_ptr->id = id;
     impl_->stopname_to_stop_[impl_->stops_[index].name] = curr_stop_ptr;
+    impl_->Change();
+    impl_->stop_index_.reset();
 }
 
 static Stop empty_stop{};
@@ -84,21 +198,96 @@ TransportCatalogue::GetAllStops() const {
 }
 
 size_t TransportCatalogue::GetStopsCount() const {
-    return impl_->stopname_to_stop_.size();
+    return impl_->stops_.size();
+}
+
+StopView TransportCatalogue::GetStop(uint32_t id) const {
+    const Stop& stop = impl_->stops_.at(id);
+    return {id, stop.name, stop.coordinates};
+}
+
+std::optional<uint32_t> TransportCatalogue::FindStopId(std::string_view name) const {
+    const auto it = impl_->stopname_to_stop_.find(name);
+    if (it == impl_->stopname_to_stop_.end()) {
+        return std::nullopt;
+    }
+    return it->second->id;
+}
+
+IdRange TransportCatalogue::GetStopsByName() const {
+    return MakeIdRange(impl_->GetNameOrder().stops);
+}
+
+IdRange TransportCatalogue::GetStopBuses(uint32_t stop_id) const {
+    if (stop_id >= impl_->stops_.size()) {
+        throw std::out_of_range("unknown stop");
+    }
+
+    std::lock_guard guard(impl_->stop_buses_mutex_);
+    if (!impl_->stop_buses_) {
+        auto stop_buses = std::make_unique<Impl::StopBuses>();
+        std::vector<uint32_t>& offsets = stop_buses->offsets;
+        offsets.reserve(impl_->stops_.size() + 1);
+        offsets.push_back(0);
+        for (const Stop& each_stop : impl_->stops_) {
+            offsets.push_back(offsets.back() + static_cast<uint32_t>(each_stop.buses.size()));
+        }
+        // остановки независимы: каждый поток заполняет и сортирует только свои отрезки
+        std::vector<uint32_t>& buses = stop_buses->buses;
+        buses.resize(offsets.back());
+        parallel::ForEachIndex(impl_->stops_.size(), [&](size_t id) {
+            const std::unordered_set<Bus*>& stop_buses = impl_->stops_[id].buses;
+            const auto buses_begin = buses.begin() + offsets[id];
+            std::transform(stop_buses.begin(), stop_buses.end(), buses_begin, [](const Bus* bus_ptr) {
+                return bus_ptr->id;
+            });
+            std::sort(buses_begin, buses.begin() + offsets[id + 1], [this](uint32_t lhs, uint32_t rhs) {
+                return impl_->buses_[lhs].name < impl_->buses_[rhs].name;
+            });
+        });
+        impl_->stop_buses_ = std::move(stop_buses);
+    }
+    const uint32_t* buses = impl_->stop_buses_->buses.data();
+    const std::vector<uint32_t>& offsets = impl_->stop_buses_->offsets;
+    return {buses + offsets[stop_id], buses + offsets[stop_id + 1]};
+}
+
+const StopIndex& TransportCatalogue::GetStopIndex() const {
+    std::lock_guard guard(impl_->stop_index_mutex_);
+    if (!impl_->stop_index_) {
+        std::vector<StopIndex::Item> items;
+        items.reserve(impl_->stops_.size());
+        for (const Stop& stop : impl_->stops_) {
+            items.push_back({stop.coordinates, stop.id, stop.name});
+        }
+        impl_->stop_index_ = std::make_unique<StopIndex>(std::move(items));
+    }
+    return *impl_->stop_index_;
 }
 
 /* ---------------- Buses ---------------- */
 void TransportCatalogue::AddBus(const Bus& bus) {
+    const uint32_t id = Impl::NextId(impl_->buses_.size());
     impl_->buses_.push_back(std::move(bus));
     
     size_t index = impl_->buses_.size() - 1u;
     const std::string_view& busnm = impl_->buses_[index].name;
     Bus* const bus_ptr = &impl_->buses_.at(index);
+    bus_ptr->id = id;
     impl_->busname_to_bus_[busnm] = bus_ptr;
 
-    for (const auto& stop : impl_->buses_[index].route) {
-        stop->buses.insert(bus_ptr);
+    const std::vector<Stop*>& route = bus_ptr->route;
+    for (size_t i = 0; i < route.size(); ++i) {
+        route[i]->buses.insert(bus_ptr);
+        impl_->route_stops_.push_back(route[i]->id);
+        impl_->route_geo_.push_back(i == 0 ? 0 : impl_->route_geo_.back()
+            + geo::ComputeDistance(route[i - 1]->coordinates, route[i]->coordinates));
     }
+    impl_->route_begins_.push_back(static_cast<uint32_t>(impl_->route_stops_.size()));
+    impl_->route_road_.resize(impl_->route_stops_.size(), 0);
+    impl_->route_reverse_road_.resize(impl_->route_stops_.size(), 0);
+    impl_->FillRoadLengths(id);
+    impl_->Change();
 }
 
 static Bus empty_bus{};
@@ -115,4 +304,78 @@ TransportCatalogue::GetAllBuses() const {
     return impl_->busname_to_bus_;
 }
 
-} // t_c
\ No newline at end of file
+std::optional<uint32_t> TransportCatalogue::FindBusId(std::string_view name) const {
+    const auto it = impl_->busname_to_bus_.find(name);
+    if (it == impl_->busname_to_bus_.end()) {
+        return std::nullopt;
+    }
+    return it->second->id;
+}
+
+IdRange TransportCatalogue::GetBusesByName() const {
+    return MakeIdRange(impl_->GetNameOrder().buses);
+}
+
+namespace {
+
+BusStat ComputeBusStat(const TransportCatalogue& catalogue, const Bus& bus) {
+    const std::vector<Stop*>& route = bus.route;
+    std::vector<Stop*> unique_stops = route;
+    std::sort(unique_stops.begin(), unique_stops.end());
+    const auto unique_end = std::unique(unique_stops.begin(), unique_stops.end());
+
+    // полные длины - последние элементы нарастающих итогов
+    const RouteLengths lengths = catalogue.GetBusRouteLengths(bus.id);
+    const double length = route.empty() ? 0 : *(lengths.road.end() - 1);
+    const double geographical_length = route.empty() ? 0 : *(lengths.geo.end() - 1);
+    return BusStat{bus.name, static_cast<int>(route.size()),
+                   static_cast<int>(unique_end - unique_stops.begin()),
+                   length, length / geographical_length};
+}
+
+} // namespace
+
+BusStat TransportCatalogue::GetBusStat(uint32_t bus_id) const {
+    if (bus_id >= impl_->buses_.size()) {
+        throw std::out_of_range("unknown bus");
+    }
+
+    std::lock_guard guard(impl_->bus_stats_mutex_);
+    if (!impl_->bus_stats_) {
+        // автобусы независимы: каждый поток пишет только в свои элементы
+        auto bus_stats = std::make_unique<Impl::BusStats>(impl_->buses_.size());
+        parallel::ForEachIndex(impl_->buses_.size(), [&](size_t id) {
+            (*bus_stats)[id] = ComputeBusStat(*this, impl_->buses_[id]);
+        });
+        impl_->bus_stats_ = std::move(bus_stats);
+    }
+    return (*impl_->bus_stats_)[bus_id];
+}
+
+size_t TransportCatalogue::GetBusesCount() const {
+    return impl_->buses_.size();
+}
+
+BusView TransportCatalogue::GetBus(uint32_t id) const {
+    const Bus& bus = impl_->buses_.at(id);
+    const uint32_t* route_stops = impl_->route_stops_.data();
+    return {id, bus.name, bus.is_roundtrip,
+            IdRange{route_stops + impl_->route_begins_[id], route_stops + impl_->route_begins_[id + 1]},
+            bus.velocity, TimeRange{bus.departures.data(), bus.departures.data() + bus.departures.size()}};
+}
+
+RouteLengths TransportCatalogue::GetBusRouteLengths(uint32_t bus_id) const {
+    const uint32_t begin = impl_->route_begins_.at(bus_id);
+    const uint32_t end = impl_->route_begins_.at(bus_id + 1);
+    const auto make_range = [begin, end](const std::vector<double>& lengths) {
+        return DistanceRange{lengths.data() + begin, lengths.data() + end};
+    };
+    return {make_range(impl_->route_road_), make_range(impl_->route_reverse_road_),
+            make_range(impl_->route_geo_)};
+}
+
+uint64_t TransportCatalogue::GetVersion() const {
+    return impl_->version_;
+}
+
+} // t_c
@@ -1,5 +1,6 @@
 #pragma once
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <set>
 #include <string>
@@ -7,16 +8,26 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <memory>
+#include <optional>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "catalogue_reader.h"
 #include "geo.h"
+#include "distance_table.h"
 #include "domain.h"
+#include "ranges.h"
+#include "stop_index.h"
 
 namespace t_c {
 
-class TransportCatalogue {
+// Остановки и автобусы получают при добавлении номера подряд с 0 (domain::Stop::id,
+// domain::Bus::id): производные структуры хранятся в массивах по этим номерам.
+// Производные данные (упорядочения по имени, автобусы остановок, статистика автобусов,
+// индекс остановок) строятся при первом обращении и перестраиваются после изменения
+// справочника; диапазоны и ссылки на них действительны до изменения
+class TransportCatalogue : public CatalogueReader {
 public:
     TransportCatalogue();
     TransportCatalogue(const TransportCatalogue&);
@@ -24,27 +35,40 @@ public:
     ~TransportCatalogue();
 
     void AddDistance(domain::Stop* fr, domain::Stop* to, const double);
+    // перед загрузкой многих расстояний: место под count пар выделяется сразу
+    void ReserveDistances(size_t count);
+    // заданное расстояние, при отсутствии - обратное. Если не найдено: -1
     double FindDistance(domain::Stop* fr, domain::Stop* to) const;
+    double FindDistance(uint32_t from_id, uint32_t to_id) const override;
 
     void AddStop(const domain::Stop&);
     domain::Stop& FindStop(const std::string_view&) const;
     const std::unordered_map<std::string_view, domain::Stop*>& GetAllStops() const;
-    size_t GetStopsCount() const;
+    size_t GetStopsCount() const override;
+    StopView GetStop(uint32_t id) const override;
+    std::optional<uint32_t> FindStopId(std::string_view name) const override;
+    IdRange GetStopsByName() const override;
+    IdRange GetStopBuses(uint32_t stop_id) const override;
+    const StopIndex& GetStopIndex() const override;
 
     void AddBus(const domain::Bus&);
     domain::Bus& FindBus(const std::string_view&) const;
     const std::unordered_map<std::string_view, domain::Bus*>& GetAllBuses() const;
+    size_t GetBusesCount() const override;
+    BusView GetBus(uint32_t id) const override;
+    std::optional<uint32_t> FindBusId(std::string_view name) const override;
+    IdRange GetBusesByName() const override;
 
+    // Считаются при добавлении автобуса и пересчитываются при добавлении расстояния
+    RouteLengths GetBusRouteLengths(uint32_t bus_id) const override;
+    // статистика считается для всех автобусов сразу, параллельно
+    domain::BusStat GetBusStat(uint32_t bus_id) const override;
 
-    class DistanceHasher {
-    static const size_t N = 576UL;
-    public:
-        size_t operator()(const std::pair<domain::Stop*, domain::Stop*>& element) const {
-            size_t hash = std::hash<const void*>{}(element.first);            
-            hash += std::hash<const void*>{}(element.second);
-            return hash;
-        }
-    };
+    // меняется при каждом добавлении остановки, автобуса или расстояния
+    uint64_t GetVersion() const override;
+
+    // все заданные расстояния по номерам остановок
+    const DistanceTable& GetDistances() const;
 
     TransportCatalogue& operator=(const TransportCatalogue& other);
     TransportCatalogue& operator=(TransportCatalogue&& other);
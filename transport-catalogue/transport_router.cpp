@@ -5,97 +5,436 @@ using namespace t_c;
 using namespace graph;
 
 TransportRouter::TransportRouter(RoutingSettings routing_settings,
-                                const TransportCatalogue& catalogue)
-    : routing_settings_(std::move(routing_settings)), catalogue_(catalogue) {
+                                const CatalogueReader& catalogue)
+    : routing_settings_(std::move(routing_settings)), catalogue_(catalogue)
+    , raptor_router_(routing_settings_, catalogue_) {
     Build();
 }
 
-std::optional<Router<double>::RouteInfo> TransportRouter::FindRoute(
+TransportRouter::TransportRouter(RoutingSettings routing_settings,
+                                const CatalogueReader& catalogue,
+                                std::istream& input)
+    : routing_settings_(std::move(routing_settings)), catalogue_(catalogue)
+    , raptor_router_(routing_settings_, catalogue_) {
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        return;
+    }
+    // вершины и ребра ссылаются на остановки и автобусы по номерам справочника:
+    // сохраненные имена подтверждают, что нумерация та же
+    const uint64_t stops_count = binary_io::Read<uint64_t>(input);
+    if (stops_count != catalogue_.GetStopsCount()) {
+        throw binary_io::ReadError("router stops do not match the catalogue");
+    }
+    for (uint32_t id = 0; id < stops_count; ++id) {
+        if (binary_io::ReadString(input) != catalogue_.GetStop(id).name) {
+            throw binary_io::ReadError("router stops do not match the catalogue");
+        }
+    }
+    const uint64_t buses_count = binary_io::Read<uint64_t>(input);
+    if (buses_count != catalogue_.GetBusesCount()) {
+        throw binary_io::ReadError("router buses do not match the catalogue");
+    }
+    for (uint32_t id = 0; id < buses_count; ++id) {
+        if (binary_io::ReadString(input) != catalogue_.GetBus(id).name) {
+            throw binary_io::ReadError("router buses do not match the catalogue");
+        }
+    }
+    first_ride_vertex_ = stops_count * 2;
+    ride_distances_ = binary_io::ReadVector<double>(input);
+
+    graph_ = std::make_unique<DirectedWeightedGraph<double>>(
+        DirectedWeightedGraph<double>::Load(input, CountVertices()));
+    router_ = LoadRouter(input);
+}
+
+std::optional<RouteStat> TransportRouter::FindRoute(
                         std::string_view stop_from,
                         std::string_view stop_to) const {
-    return router_->BuildRoute(
-        stopnames_to_ids_.at(std::string(stop_from)),
-        stopnames_to_ids_.at(std::string(stop_to))
-    );
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        // без расписаний время маршрута не зависит от отправления
+        std::vector<RaptorRouter::Journey> journeys = raptor_router_.FindJourneys(
+            {{FindStopId(stop_from), 0}}, {{FindStopId(stop_to), 0}}, false);
+        if (journeys.empty()) {
+            return std::nullopt;
+        }
+        return MakeRouteStat(std::move(journeys.back()));
+    }
+
+    const auto route = router_->BuildRoute(GetWaitVertex(FindStopId(stop_from)),
+                                           GetWaitVertex(FindStopId(stop_to)));
+    if (!route) {
+        return std::nullopt;
+    }
+
+    RouteStat stat;
+    AddRouteItems(route->edges, stat);
+    for (const RouteItem& item : stat.items) {
+        stat.total_time += item.time;
+    }
+    return stat;
+}
+
+std::optional<RouteStat> TransportRouter::FindRoute(
+                        std::string_view stop_from,
+                        std::string_view stop_to,
+                        double departure_time) const {
+    std::vector<RaptorRouter::Journey> journeys = raptor_router_.FindJourneys(
+        {{FindStopId(stop_from), departure_time}}, {{FindStopId(stop_to), 0}}, true);
+    if (journeys.empty()) {
+        return std::nullopt;
+    }
+    return MakeRouteStat(std::move(journeys.back()));
+}
+
+std::vector<RouteStat> TransportRouter::FindRoutes(
+                        std::string_view stop_from,
+                        std::string_view stop_to,
+                        std::optional<double> departure_time) const {
+    const double departure = departure_time.value_or(0);
+    std::vector<RaptorRouter::Journey> journeys = raptor_router_.FindJourneys(
+        {{FindStopId(stop_from), departure}}, {{FindStopId(stop_to), 0}}, departure_time.has_value());
+    std::vector<RouteStat> routes;
+    routes.reserve(journeys.size());
+    for (RaptorRouter::Journey& journey : journeys) {
+        routes.push_back(MakeRouteStat(std::move(journey)));
+    }
+    return routes;
+}
+
+RouteStat TransportRouter::MakeRouteStat(RaptorRouter::Journey&& journey) {
+    RouteStat stat;
+    stat.items = std::move(journey.items);
+    for (const RouteItem& item : stat.items) {
+        stat.total_time += item.time;
+    }
+    return stat;
+}
+
+RouteStat TransportRouter::FindRoute(geo::Coordinates from, geo::Coordinates to) const {
+    // начала и концы поиска - ближайшие остановки (их вершины ожидания) с временем пути пешком
+    const size_t walk_stops_count = static_cast<size_t>(routing_settings_.walk_stops_count);
+    const StopIndex& stop_index = catalogue_.GetStopIndex();
+    const std::vector<StopIndex::FoundStop> from_stops = stop_index.FindNearest(from, walk_stops_count);
+    const std::vector<StopIndex::FoundStop> to_stops = stop_index.FindNearest(to, walk_stops_count);
+    const double direct_distance = geo::ComputeDistance(from, to);
+    const double direct_time = ComputeWalkTimeInMinutes(direct_distance);
+    RouteStat stat;
+    const auto add_walk = [this, &stat](const StopIndex::FoundStop& found_stop) {
+        stat.items.push_back({RouteItemType::WALK, found_stop.name, 0,
+                              ComputeWalkTimeInMinutes(found_stop.distance), found_stop.distance});
+    };
+
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        const auto make_terminals = [this](const std::vector<StopIndex::FoundStop>& stops) {
+            std::vector<RaptorRouter::Terminal> terminals;
+            terminals.reserve(stops.size());
+            for (const auto& [stop_id, name, distance] : stops) {
+                terminals.push_back({stop_id, ComputeWalkTimeInMinutes(distance)});
+            }
+            return terminals;
+        };
+        std::vector<RaptorRouter::Journey> journeys = raptor_router_.FindJourneys(
+            make_terminals(from_stops), make_terminals(to_stops), false);
+        if (journeys.empty() || !(journeys.back().arrival < direct_time)) {
+            stat.items.push_back({RouteItemType::WALK, {}, 0, direct_time, direct_distance});
+        } else {
+            RaptorRouter::Journey& journey = journeys.back();
+            add_walk(from_stops[journey.source]);
+            stat.items.insert(stat.items.end(), journey.items.begin(), journey.items.end());
+            add_walk(to_stops[journey.target]);
+        }
+    } else {
+        const auto make_terminals = [this](const std::vector<StopIndex::FoundStop>& stops) {
+            std::vector<Router<double>::Terminal> terminals;
+            terminals.reserve(stops.size());
+            for (const auto& [stop_id, name, distance] : stops) {
+                terminals.push_back({GetWaitVertex(stop_id), ComputeWalkTimeInMinutes(distance)});
+            }
+            return terminals;
+        };
+        const auto route = router_->BuildBestRoute(make_terminals(from_stops), make_terminals(to_stops));
+        if (!route || !(route->route.weight < direct_time)) {
+            stat.items.push_back({RouteItemType::WALK, {}, 0, direct_time, direct_distance});
+        } else {
+            add_walk(from_stops[route->source]);
+            AddRouteItems(route->route.edges, stat);
+            add_walk(to_stops[route->target]);
+        }
+    }
+    for (const RouteItem& item : stat.items) {
+        stat.total_time += item.time;
+    }
+    return stat;
+}
+
+void TransportRouter::AddRouteItems(const std::vector<EdgeId>& edges, RouteStat& stat) const {
+    // посадка, поездки через несколько остановок и выход складываются в один элемент "Bus"
+    double ride_distance = 0;
+    for (const EdgeId edge_id : edges) {
+        const Edge<double>& edge = graph_->GetEdge(edge_id);
+        switch (edge.type) {
+            case EdgeType::WAIT:
+                stat.items.push_back({RouteItemType::WAIT, catalogue_.GetStop(edge.name_id).name, 0, edge.weight});
+                break;
+            case EdgeType::BUS:
+                stat.items.push_back({RouteItemType::BUS, catalogue_.GetBus(edge.name_id).name,
+                                      static_cast<int>(edge.span), edge.weight});
+                break;
+            case EdgeType::BOARD:
+                stat.items.push_back({RouteItemType::BUS, catalogue_.GetBus(edge.name_id).name, 0, 0});
+                ride_distance = 0;
+                break;
+            case EdgeType::RIDE:
+                stat.items.back().span_count += 1;
+                ride_distance += ride_distances_[edge.from - first_ride_vertex_];
+                break;
+            case EdgeType::ALIGHT:
+                // время считается по суммарному расстоянию, как у ребра BUS
+                stat.items.back().time = ComputeRoadTimeInMinutes(ride_distance,
+                                                                  catalogue_.GetBus(edge.name_id).velocity);
+                break;
+        }
+    }
 }
 
 const DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
+    if (!graph_) {
+        throw std::logic_error("graph is not built in raptor mode");
+    }
     return *graph_;
 }
 
+const RoutingSettings& TransportRouter::GetRoutingSettings() const {
+    return routing_settings_;
+}
+
+void TransportRouter::Save(std::ostream& output) const {
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        return;
+    }
+    binary_io::Write<uint64_t>(output, catalogue_.GetStopsCount());
+    for (uint32_t id = 0; id < catalogue_.GetStopsCount(); ++id) {
+        binary_io::WriteString(output, catalogue_.GetStop(id).name);
+    }
+    binary_io::Write<uint64_t>(output, catalogue_.GetBusesCount());
+    for (uint32_t id = 0; id < catalogue_.GetBusesCount(); ++id) {
+        binary_io::WriteString(output, catalogue_.GetBus(id).name);
+    }
+    binary_io::WriteVector(output, ride_distances_);
+
+    graph_->Save(output);
+    router_->Save(output);
+}
+
 void TransportRouter::Build() {
-    // инициализируем граф количеством остановок (вершин) * 2
-    graph_ = std::make_unique<DirectedWeightedGraph<double>>(
-                                        catalogue_.GetStopsCount()*2
-                                    );
+    // поиску по раундам хватает маршрутов автобусов из справочника
+    if (routing_settings_.router_mode == RouterMode::RAPTOR) {
+        return;
+    }
+    // инициализируем граф количеством остановок (вершин) * 2 и, если нужно, вершинами поездок
+    graph_ = std::make_unique<DirectedWeightedGraph<double>>(CountVertices());
     // создаем по 2 вершины на остановку, где вес ребра между - время ожидания
     InitializeGraphWithStops();
     // обозначим время от одной остановки к другой на оном маршруте
     FillGraph();
-    router_ = std::make_unique<Router<double>>(*graph_);
+    // граф больше не меняется: переводим его в компактный формат для маршрутизатора
+    graph_->Freeze();
+    router_ = MakeRouter();
+}
+
+std::unique_ptr<Router<double>> TransportRouter::MakeRouter() const {
+    switch (routing_settings_.router_mode) {
+        case RouterMode::ALL_PAIRS:
+            return std::make_unique<AllPairsRouter<double>>(*graph_);
+        case RouterMode::ON_DEMAND:
+            return std::make_unique<DijkstraRouter<double>>(*graph_);
+        case RouterMode::CONTRACTION_HIERARCHIES:
+            return std::make_unique<ContractionHierarchiesRouter<double>>(*graph_);
+        case RouterMode::RAPTOR:
+            throw std::logic_error("raptor mode does not use a graph router");
+    }
+    throw std::invalid_argument("unknown router mode");
+}
+
+std::unique_ptr<Router<double>> TransportRouter::LoadRouter(std::istream& input) const {
+    switch (routing_settings_.router_mode) {
+        case RouterMode::ALL_PAIRS:
+            return std::make_unique<AllPairsRouter<double>>(*graph_, input);
+        case RouterMode::ON_DEMAND:
+            return std::make_unique<DijkstraRouter<double>>(*graph_);
+        case RouterMode::CONTRACTION_HIERARCHIES:
+            return std::make_unique<ContractionHierarchiesRouter<double>>(*graph_, input);
+        case RouterMode::RAPTOR:
+            throw std::logic_error("raptor mode does not use a graph router");
+    }
+    throw std::invalid_argument("unknown router mode");
 }
 
 void TransportRouter::InitializeGraphWithStops() {
     // так как на остановках 2 вершины, 1-я отвечает за ожидание, а вторая - за отправление
-    size_t vertex_id = 0;
-    for (const auto& [stop_name, stop_ptr] : catalogue_.GetAllStops()) {
-        stopnames_to_ids_[std::string(stop_name)] = vertex_id;
+    for (uint32_t id = 0; id < catalogue_.GetStopsCount(); ++id) {
+        const VertexId vertex_id = GetWaitVertex(id);
         Edge<double> wait_edge{
             vertex_id,
-            ++vertex_id,
+            vertex_id + 1,
             routing_settings_.wait_time,
-            true,
             0,
-            std::string(stop_name)
+            id,
+            EdgeType::WAIT
         };
         graph_->AddEdge(wait_edge);
-        ++vertex_id;
     }
 }
 
-double TransportRouter::ComputeRoadTimeInMinutes(double distance) const {
+uint32_t TransportRouter::FindStopId(std::string_view stop_name) const {
+    const std::optional<uint32_t> stop_id = catalogue_.FindStopId(stop_name);
+    if (!stop_id) {
+        throw std::out_of_range("unknown stop");
+    }
+    return *stop_id;
+}
+
+VertexId TransportRouter::GetWaitVertex(uint32_t stop_id) {
+    return static_cast<VertexId>(stop_id) * 2;
+}
+
+double TransportRouter::ComputeRoadTimeInMinutes(double distance, double bus_velocity) const {
     static const double METERS_IN_KILOMETER = 1000;
     static const double MINUTES_IN_HOUR = 60;
-    double velocity_meter_minutes = routing_settings_.velocity * METERS_IN_KILOMETER / MINUTES_IN_HOUR;
+    const double velocity = bus_velocity > 0 ? bus_velocity : routing_settings_.velocity;
+    double velocity_meter_minutes = velocity * METERS_IN_KILOMETER / MINUTES_IN_HOUR;
     return distance / velocity_meter_minutes;
 }
 
+double TransportRouter::ComputeWalkTimeInMinutes(double distance) const {
+    static const double METERS_IN_KILOMETER = 1000;
+    static const double MINUTES_IN_HOUR = 60;
+    return distance / (routing_settings_.walk_velocity * METERS_IN_KILOMETER / MINUTES_IN_HOUR);
+}
+
+bool TransportRouter::UsesRideVertices() const {
+    // всем парам вершин нужен граф с минимумом вершин, поиску по запросу - с минимумом ребер
+    return routing_settings_.router_mode != RouterMode::ALL_PAIRS;
+}
+
+size_t TransportRouter::CountVertices() const {
+    size_t vertex_count = catalogue_.GetStopsCount() * 2;
+    if (UsesRideVertices()) {
+        for (uint32_t id = 0; id < catalogue_.GetBusesCount(); ++id) {
+            vertex_count += catalogue_.GetBus(id).route.size();
+        }
+    }
+    return vertex_count;
+}
+
 void TransportRouter::FillGraph() {
-    for (const auto &[bus_name, bus_ptr]: catalogue_.GetAllBuses()) {
-        const auto &stops = bus_ptr->route;
-        size_t stops_count = stops.size();
-        for (size_t i = 0; i < stops_count; ++i) {
-            const Stop* stop_from = stops[i];
-            size_t dist_sum = 0;
-            size_t dist_reverse_sum = 0;
-
-            for (size_t j = i + 1; j < stops_count; ++j) {
-                const Stop* stop_to = stops[j];
-                dist_sum += catalogue_.FindDistance(stops[j - 1], stops[j]);
-                dist_reverse_sum += catalogue_.FindDistance(stops[j], stops[j - 1]);
-
-                const Edge<double> straight_edge {
-                    stopnames_to_ids_.at(stop_from->name) + 1,
-                    stopnames_to_ids_.at(stop_to->name),
-                    ComputeRoadTimeInMinutes(dist_sum),
-                    false,
-                    static_cast<int>(j - i),
-                    bus_ptr->name
-                };
-                graph_->AddEdge(straight_edge);
-
-                if (!bus_ptr->is_roundtrip) {
-                    const Edge<double> reverse_edge {
-                        stopnames_to_ids_.at(stop_to->name) + 1,
-                        stopnames_to_ids_.at(stop_from->name),
-                        ComputeRoadTimeInMinutes(dist_reverse_sum),
-                        false,
-                        static_cast<int>(j - i),
-                        bus_ptr->name
-                    };
-                    graph_->AddEdge(reverse_edge);
-                }
+    // автобусы идут по номерам: от порядка зависят номера вершин поездок и ребер
+    const size_t buses_count = catalogue_.GetBusesCount();
+    std::vector<VertexId> first_ride_vertices;
+    first_ride_vertices.reserve(buses_count);
+    // вершины поездок идут после вершин остановок
+    first_ride_vertex_ = catalogue_.GetStopsCount() * 2;
+    VertexId ride_vertex = first_ride_vertex_;
+    for (uint32_t id = 0; id < buses_count; ++id) {
+        first_ride_vertices.push_back(ride_vertex);
+        if (UsesRideVertices()) {
+            ride_vertex += catalogue_.GetBus(id).route.size();
+        }
+    }
+
+    // автобусы независимы: ребра каждого строятся в своем буфере в пуле потоков...
+    std::vector<BusEdges> buses_edges(buses_count);
+    parallel::ForEachIndex(buses_count, [&](size_t bus_index) {
+        const uint32_t bus_id = static_cast<uint32_t>(bus_index);
+        const BusView bus = catalogue_.GetBus(bus_id);
+        if (UsesRideVertices()) {
+            MakeRideEdges(bus, first_ride_vertices[bus_index], buses_edges[bus_index]);
+        } else {
+            MakeSpanEdges(bus, buses_edges[bus_index]);
+        }
+    });
+
+    // ...и добавляются в граф в порядке автобусов, поэтому номера ребер не зависят от потоков
+    for (BusEdges& bus_edges : buses_edges) {
+        for (const Edge<double>& edge : bus_edges.edges) {
+            graph_->AddEdge(edge);
+        }
+        ride_distances_.insert(ride_distances_.end(),
+                               bus_edges.ride_distances.begin(), bus_edges.ride_distances.end());
+        bus_edges = {};
+    }
+}
+
+std::vector<VertexId> TransportRouter::GetRouteVertices(const BusView& bus) const {
+    std::vector<VertexId> stops;
+    stops.reserve(bus.route.size());
+    for (const uint32_t stop_id : bus.route) {
+        stops.push_back(GetWaitVertex(stop_id));
+    }
+    return stops;
+}
+
+void TransportRouter::MakeSpanEdges(const BusView& bus, BusEdges& bus_edges) const {
+    const std::vector<VertexId> stops = GetRouteVertices(bus);
+    const size_t stops_count = stops.size();
+
+    // длины от начала маршрута в обе стороны: длина участка - разность двух элементов
+    const RouteLengths lengths = catalogue_.GetBusRouteLengths(bus.id);
+    const double* road = lengths.road.begin();
+    const double* reverse_road = lengths.reverse_road.begin();
+
+    const size_t edges_count = stops_count * (stops_count - 1) / 2;
+    bus_edges.edges.reserve(bus.is_roundtrip ? edges_count : edges_count * 2);
+    for (size_t i = 0; i < stops_count; ++i) {
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            bus_edges.edges.push_back({
+                stops[i] + 1,
+                stops[j],
+                ComputeRoadTimeInMinutes(road[j] - road[i], bus.velocity),
+                static_cast<uint32_t>(j - i),
+                bus.id,
+                EdgeType::BUS
+            });
+
+            if (!bus.is_roundtrip) {
+                bus_edges.edges.push_back({
+                    stops[j] + 1,
+                    stops[i],
+                    ComputeRoadTimeInMinutes(reverse_road[j] - reverse_road[i], bus.velocity),
+                    static_cast<uint32_t>(j - i),
+                    bus.id,
+                    EdgeType::BUS
+                });
             }
         }
     }
 }
+
+void TransportRouter::MakeRideEdges(const BusView& bus, VertexId first_ride_vertex,
+                                    BusEdges& bus_edges) const {
+    // Каждой позиции маршрута соответствует вершина "в автобусе". Из вершины отправления
+    // остановки в нее можно сесть, в следующую позицию - проехать, на остановку - выйти.
+    // Некольцевой маршрут уже развернут туда и обратно, поэтому обратные ребра не нужны
+    const std::vector<VertexId> stops = GetRouteVertices(bus);
+    const size_t stops_count = stops.size();
+    const double* road = catalogue_.GetBusRouteLengths(bus.id).road.begin();
+    bus_edges.edges.reserve(stops_count * 3);
+    bus_edges.ride_distances.reserve(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        const VertexId ride_vertex = first_ride_vertex + i;
+        const bool is_last = i + 1 == stops_count;
+        // у последней позиции перегона нет, но место в массиве нужно для индексации
+        const double distance = is_last ? 0 : road[i + 1] - road[i];
+        bus_edges.ride_distances.push_back(distance);
+
+        if (!is_last) {
+            bus_edges.edges.push_back({stops[i] + 1, ride_vertex, 0, 0, bus.id, EdgeType::BOARD});
+            bus_edges.edges.push_back({ride_vertex, ride_vertex + 1,
+                                       ComputeRoadTimeInMinutes(distance, bus.velocity),
+                                       1, bus.id, EdgeType::RIDE});
+        }
+        if (i > 0) {
+            bus_edges.edges.push_back({ride_vertex, stops[i], 0, 0, bus.id, EdgeType::ALIGHT});
+        }
+    }
+}
@@ -1,41 +1,119 @@
 #pragma once
 
+#include <iostream>
 #include <unordered_map>
 #include <string_view>
 #include <string>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <vector>
 
-#include "transport_catalogue.h"
+#include "catalogue_reader.h"
+#include "stop_index.h"
+#include "geo.h"
+#include "binary_io.h"
 #include "domain.h"
 #include "graph.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchies.h"
+#include "parallel.h"
+#include "raptor_router.h"
 
 
 class TransportRouter {
 public:
-    TransportRouter(domain::RoutingSettings, const t_c::TransportCatalogue&);
+    TransportRouter(domain::RoutingSettings, const t_c::CatalogueReader&);
+    // восстанавливает маршрутизатор, сохраненный Save, по тому же справочнику:
+    // граф и предподсчет маршрутизатора не перестраиваются.
+    // В режиме RAPTOR графа нет, и сохранять нечего
+    TransportRouter(domain::RoutingSettings, const t_c::CatalogueReader&, std::istream&);
 
-    std::optional<graph::Router<double>::RouteInfo> FindRoute(
+    std::optional<domain::RouteStat> FindRoute(
                             std::string_view,
                             std::string_view) const;
 
+    // Маршрут между точками: пешком до одной из ближайших к началу остановок, по графу (по маршрутам)
+    // и пешком от одной из ближайших к концу остановок - все варианты одним поиском.
+    // Если пешком напрямую не дольше, маршрут - один переход
+    domain::RouteStat FindRoute(geo::Coordinates, geo::Coordinates) const;
+
+    // Маршрут с самым ранним прибытием при отправлении в departure_time (минуты от начала
+    // суток) по расписаниям автобусов; ищется по маршрутам автобусов, а не по графу
+    std::optional<domain::RouteStat> FindRoute(
+                            std::string_view,
+                            std::string_view,
+                            double departure_time) const;
+
+    // Маршруты, оптимальные по числу поездок и времени: по возрастанию числа пересадок,
+    // каждый следующий быстрее предыдущего. С departure_time - по расписаниям.
+    // Ищутся по маршрутам автобусов в любом режиме; если пути нет - пустой вектор
+    std::vector<domain::RouteStat> FindRoutes(
+                            std::string_view,
+                            std::string_view,
+                            std::optional<double> departure_time) const;
+
+    // в режиме RAPTOR граф не строится
     const graph::DirectedWeightedGraph<double>& GetGraph() const;
+    const domain::RoutingSettings& GetRoutingSettings() const;
+
+    // имена остановок и автобусов по номерам для проверки, граф и данные маршрутизатора
+    void Save(std::ostream&) const;
 
 private:
     void Build();
 
+    std::unique_ptr<graph::Router<double>> MakeRouter() const;
+    std::unique_ptr<graph::Router<double>> LoadRouter(std::istream&) const;
+
     void InitializeGraphWithStops();
 
-    double ComputeRoadTimeInMinutes(double) const;
+    // номер остановки в справочнике; неизвестная остановка - std::out_of_range
+    uint32_t FindStopId(std::string_view stop_name) const;
+    // остановка с номером id занимает вершины 2 * id (ожидание) и 2 * id + 1 (отправление)
+    static graph::VertexId GetWaitVertex(uint32_t stop_id);
+
+    // время в пути со скоростью автобуса, а если она не задана - со скоростью из настроек
+    double ComputeRoadTimeInMinutes(double distance, double bus_velocity) const;
+    double ComputeWalkTimeInMinutes(double) const;
+
+    // элементы маршрута по ребрам найденного пути
+    void AddRouteItems(const std::vector<graph::EdgeId>&, domain::RouteStat&) const;
+
+    // маршрут из варианта, найденного по маршрутам автобусов; total_time - сумма элементов,
+    // как у маршрутов по графу
+    static domain::RouteStat MakeRouteStat(RaptorRouter::Journey&&);
+
+    bool UsesRideVertices() const;
+
+    size_t CountVertices() const;
+
+    // ребра одного автобуса, построенные независимо от остальных
+    struct BusEdges {
+        std::vector<graph::Edge<double>> edges;
+        std::vector<double> ride_distances;
+    };
 
     void FillGraph();
 
+    // вершины ожидания остановок маршрута
+    std::vector<graph::VertexId> GetRouteVertices(const t_c::BusView&) const;
+
+    // ребра от каждой остановки до каждой следующей на маршруте: O(k^2) ребер на маршрут
+    void MakeSpanEdges(const t_c::BusView&, BusEdges&) const;
+
+    // цепочка вершин поездки вдоль маршрута: O(k) вершин и ребер на маршрут
+    void MakeRideEdges(const t_c::BusView&, graph::VertexId first_ride_vertex, BusEdges&) const;
+
 private:
     std::unique_ptr< graph::DirectedWeightedGraph<double> > graph_;
     std::unique_ptr< graph::Router<double> > router_;
-    std::unordered_map<std::string, size_t> stopnames_to_ids_;
+    // расстояние от вершины поездки до следующей по маршруту, по номеру вершины от first_ride_vertex_
+    graph::VertexId first_ride_vertex_ = 0;
+    std::vector<double> ride_distances_;
 
     const domain::RoutingSettings routing_settings_;
-    const t_c::TransportCatalogue& catalogue_;
+    const t_c::CatalogueReader& catalogue_;
+    const RaptorRouter raptor_router_;
 };